@@ -0,0 +1,92 @@
+#include "ArmModel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr float GRAVITY = 9.81f;
+    constexpr float DEG_TO_RAD = float(M_PI) / 180.0f;
+
+    // link_1 about the vertical, and the J2 axis' reach from it (m)
+    constexpr float I_BASE = 0.0357f;
+    constexpr float D_J2 = 0.0698f;
+    // link_2 (upper arm): mass, J2 to its centre of mass, own inertia about
+    // the pitch axis, J2 to J3
+    constexpr float M_UPPER = 8.3761f, R_UPPER = 0.2169f, I_UPPER = 0.0716f;
+    constexpr float L_UPPER = 0.48086f;
+    // link_3 (forearm), from J3
+    constexpr float M_FORE = 8.2246f, R_FORE = 0.1466f, I_FORE = 0.0136f;
+    // link_4..link_6 (wrist, tool straight out) lumped on the forearm line
+    constexpr float M_WRIST = 3.0029f, R_WRIST = 0.4258f, I_WRIST = 0.0224f;
+
+    constexpr size_t J1 = 0, J2 = 1, J3 = 2;
+}
+
+void ArmModel::load(float sin2, float sin23, float cos3, Load &out)
+{
+    float foreMoment = M_FORE * R_FORE + M_WRIST * R_WRIST; // J3 to the forearm's mass centre
+    out.gravity[J1] = 0;
+    out.gravity[J2] = GRAVITY * ((M_UPPER * R_UPPER + (M_FORE + M_WRIST) * L_UPPER) * sin2 + foreMoment * sin23);
+    out.gravity[J3] = GRAVITY * foreMoment * sin23;
+
+    float l2 = L_UPPER * L_UPPER;
+    out.inertia[J3] = I_FORE + M_FORE * R_FORE * R_FORE + I_WRIST + M_WRIST * R_WRIST * R_WRIST;
+    out.inertia[J2] = I_UPPER + M_UPPER * R_UPPER * R_UPPER + I_FORE + I_WRIST +
+                      M_FORE * (l2 + R_FORE * R_FORE + 2.0f * L_UPPER * R_FORE * cos3) +
+                      M_WRIST * (l2 + R_WRIST * R_WRIST + 2.0f * L_UPPER * R_WRIST * cos3);
+
+    // J1 swings every link about the vertical at its horizontal reach
+    float upper = D_J2 + R_UPPER * sin2;
+    float fore = D_J2 + L_UPPER * sin2 + R_FORE * sin23;
+    float wrist = D_J2 + L_UPPER * sin2 + R_WRIST * sin23;
+    out.inertia[J1] = I_BASE + I_UPPER * sin2 * sin2 + M_UPPER * upper * upper +
+                      I_FORE * sin23 * sin23 + M_FORE * fore * fore + I_WRIST + M_WRIST * wrist * wrist;
+}
+
+// Largest |sin| over lo..hi (rad)
+float ArmModel::maxAbsSin(float lo, float hi)
+{
+    const float pi = float(M_PI);
+    if (hi - lo >= pi)
+        return 1.0f;
+    float peak = 0.5f * pi + pi * ceilf((lo - 0.5f * pi) / pi);
+    if (peak <= hi)
+        return 1.0f;
+    return fmaxf(fabsf(sinf(lo)), fabsf(sinf(hi)));
+}
+
+// Largest cos over lo..hi (rad)
+float ArmModel::maxCos(float lo, float hi)
+{
+    const float turn = 2.0f * float(M_PI);
+    if (turn * ceilf(lo / turn) <= hi)
+        return 1.0f;
+    return fmaxf(cosf(lo), cosf(hi));
+}
+
+void ArmModel::accelScale(const float loDeg[CONFIG_JOINT_COUNT],
+                          const float hiDeg[CONFIG_JOINT_COUNT],
+                          const float accelDegPerSec2[CONFIG_JOINT_COUNT],
+                          float maxScale,
+                          float scale[CONFIG_JOINT_COUNT])
+{
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        scale[j] = 1.0f;
+    if (!(maxScale > 1.0f))
+        return;
+
+    float lo2 = loDeg[J2] * DEG_TO_RAD, hi2 = hiDeg[J2] * DEG_TO_RAD;
+    float lo3 = loDeg[J3] * DEG_TO_RAD, hi3 = hiDeg[J3] * DEG_TO_RAD;
+    Load ext, pose;
+    load(1.0f, 1.0f, 1.0f, ext);
+    load(maxAbsSin(lo2, hi2), maxAbsSin(lo2 + lo3, hi2 + hi3), maxCos(lo3, hi3), pose);
+
+    for (size_t j : {J1, J2, J3})
+    {
+        float a = accelDegPerSec2[j] * DEG_TO_RAD;
+        if (!(a > 0.0f))
+            continue;
+        float torque = ext.inertia[j] * a + ext.gravity[j] - pose.gravity[j];
+        scale[j] = std::min(std::max(torque / (pose.inertia[j] * a), 1.0f), maxScale);
+    }
+}
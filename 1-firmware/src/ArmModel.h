@@ -0,0 +1,39 @@
+#ifndef ARM_MODEL_H
+#define ARM_MODEL_H
+
+#include <stddef.h>
+#include "Config.h"
+
+// Pose-dependent acceleration limits (loop side). The configured
+// maxAcceleration of J1..J3 is what the drive manages with the arm fully
+// extended under gravity. A planar gravity/inertia model, lumped from the
+// link masses and inertias in 6AR-000-000.SLDASM.urdf, gives the torque
+// that leaves in any other pose, so the limit scales by
+//   (I_ext * a + G_ext - G(q)) / (I(q) * a)
+// with I the inertia the joint moves and G the gravity torque it holds.
+// Joint angles are the firmware's degrees, which are the URDF's.
+class ArmModel
+{
+public:
+    // Scale (1..maxScale) of each joint's accel limit that holds anywhere
+    // in the pose box loDeg..hiDeg; joints the model does not cover get 1
+    static void accelScale(const float loDeg[CONFIG_JOINT_COUNT],
+                           const float hiDeg[CONFIG_JOINT_COUNT],
+                           const float accelDegPerSec2[CONFIG_JOINT_COUNT],
+                           float maxScale,
+                           float scale[CONFIG_JOINT_COUNT]);
+
+private:
+    struct Load
+    {
+        float inertia[3]; // kg·m² about J1, J2, J3
+        float gravity[3]; // N·m held at J1, J2, J3
+    };
+    // Worst case over a box, from the largest |sin q2|, |sin(q2 + q3)|
+    // and cos q3 in it (all 1 = fully extended)
+    static void load(float sin2, float sin23, float cos3, Load &out);
+    static float maxAbsSin(float lo, float hi);
+    static float maxCos(float lo, float hi);
+};
+
+#endif // ARM_MODEL_H
@@ -69,7 +69,7 @@ void CalibrationManager::homeJoint(size_t joint,
   jobJoint = joint;
 
   // 1) fast jog into the switch
-  JointManager::instance().jog(jobJoint, -fastSpeed, fastSpeed * 2.0f);
+  JointManager::instance().jog(jobJoint, -fastSpeed, fastSpeed * 2.0f, /*ignoreLimits=*/true);
   phase = CAL_FAST_FORWARD;
 }
 
@@ -135,7 +135,7 @@ void CalibrationManager::update()
           break;
         }
         // now truly done with back-off: begin slow approach
-        JM.jog(jobJoint, -slowSpeed, slowSpeed * 2.0f);
+        JM.jog(jobJoint, -slowSpeed, slowSpeed * 2.0f, /*ignoreLimits=*/true);
         phase = CAL_SLOW_APPROACH;
       }
       // if hit==true, we’re still on the switch: keep looping here
@@ -12,11 +12,15 @@ static constexpr uint32_t FNV_PRIME = 16777619u;
 
 static constexpr uint8_t SUBDIVISIONS = 50;
 
+// SetShaper/GetShaper "type", indexed by ShaperType
+static const char *const SHAPER_NAMES[] = {"none", "zv", "zvd", "ei"};
+
 size_t _segIndex = 0;
 uint8_t _substep = 0;
 float _dtSec = 0.0f;
 float _prevSpeeds[CONFIG_JOINT_COUNT];
 float _accelPerSub[CONFIG_JOINT_COUNT];
+float _segAccel[CONFIG_JOINT_COUNT];
 
 static constexpr uint32_t fnv1a(const char *s)
 {
@@ -162,6 +166,7 @@ void CommManager::handleBeginBatch(JsonObject &doc)
   {
     _prevSpeeds[j] = 0.0f;
     _accelPerSub[j] = 0.0f;
+    _segAccel[j] = 0.0f;
   }
 
   // put all joints into jog mode at 0 speed (so slices update cleanly)
@@ -171,6 +176,18 @@ void CommManager::handleBeginBatch(JsonObject &doc)
   sendCallback("BeginBatch", true);
 }
 
+// One value per axis. The arm joints are required; external axes (J7+)
+// left off the end are sent 0, so a 6-axis host keeps working as is.
+static bool readAxisArray(JsonArray arr, float out[CONFIG_JOINT_COUNT])
+{
+  size_t n = arr.size();
+  if (n < ARM_JOINT_COUNT || n > CONFIG_JOINT_COUNT)
+    return false;
+  for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    out[j] = j < n ? arr[j].as<float>() : 0.0f;
+  return true;
+}
+
 // ——— handleBatchSegmentBatch() ———————————————————————
 void CommManager::handleBatchSegmentBatch(JsonObject &doc)
 {
@@ -179,18 +196,12 @@ void CommManager::handleBatchSegmentBatch(JsonObject &doc)
     sendCallback("SegmentError", false, "tooMany");
     return;
   }
-  auto arrS = doc["s"].as<JsonArray>();
-  auto arrA = doc["a"].as<JsonArray>();
-  if (arrS.size() != CONFIG_JOINT_COUNT || arrA.size() != CONFIG_JOINT_COUNT)
+  auto &seg = _batch[_loaded];
+  if (!readAxisArray(doc["s"], seg.speeds) || !readAxisArray(doc["a"], seg.accels))
   {
     sendCallback("SegmentError", false, "badLength");
     return;
   }
-  for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
-  {
-    _batch[_loaded].speeds[j] = arrS[j].as<float>();
-    _batch[_loaded].accels[j] = arrA[j].as<float>();
-  }
   _loaded++;
   sendCallback("SegmentLoaded", true);
 
@@ -198,6 +209,8 @@ void CommManager::handleBatchSegmentBatch(JsonObject &doc)
   {
     _state = State::EXECUTING;
     _lastExecUs = micros();
+    _batchScale = 1.0f;
+    _batchOverride = JointManager::instance().getOverride();
     sendCallback("BatchExecStart", true);
   }
 }
@@ -216,8 +229,10 @@ void CommManager::handleBatchExecution()
   if (_state != State::EXECUTING)
     return;
 
+  // a slowed (or overridden) sub-step lasts 1/scale as long, so the joints still cover
+  // the distance the batch planned
   uint32_t now = micros();
-  if (now - _lastExecUs < _dtUs / SUBDIVISIONS)
+  if (now - _lastExecUs < uint32_t(float(_dtUs / SUBDIVISIONS) / _batchScale))
     return;
   _lastExecUs = now;
 
@@ -236,6 +251,8 @@ void CommManager::handleBatchExecution()
     for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
     {
       _accelPerSub[j] = seg.accels[j] * _dtSec / float(SUBDIVISIONS);
+      // what the path itself asks of the joint: from the last segment's speed to this one's
+      _segAccel[j] = fabsf(seg.speeds[j] - _prevSpeeds[j]) / _dtSec;
     }
   }
 
@@ -249,8 +266,26 @@ void CommManager::handleBatchExecution()
     // Note: we only need a magnitude for accel; direction is in speed sign
   }
 
-  // Apply the mini-step to steppers (velocity mode)
-  JointManager::instance().feedVelocitySlice(speeds, accels);
+  // Feed override: the sub-step clock runs _batchOverride times as fast,
+  // so speeds scale by it and accels by its square; slewing it toward the
+  // commanded one adds its rate of change times the speed on top
+  float subSec = _dtSec / float(SUBDIVISIONS);
+  float s0 = _batchOverride;
+  _batchOverride = JointManager::instance().slewOverride(s0, speeds, accels, subSec);
+  float slew = fabsf(_batchOverride - s0) / subSec;
+  float pathAccels[CONFIG_JOINT_COUNT];
+  for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+  {
+    accels[j] = accels[j] * _batchOverride * _batchOverride + slew * fabsf(speeds[j]);
+    pathAccels[j] = _segAccel[j] * _batchOverride * _batchOverride;
+    speeds[j] *= _batchOverride;
+  }
+
+  // Apply the mini-step to steppers (velocity mode); the speed limiter
+  // judges the path by its speeds, its slew and the accels between its
+  // segments, slowing every joint alike
+  float k = JointManager::instance().feedVelocitySlice(speeds, accels, pathAccels);
+  _batchScale = fmaxf(k * _batchOverride, 0.01f);
 
   if (++_substep >= SUBDIVISIONS)
   {
@@ -313,6 +348,9 @@ void CommManager::dispatchCommand(JsonObject doc)
   case fnv1a("Jog"):
     handleJog(doc);
     break;
+  case fnv1a("JogTo"):
+    handleJogTo(doc);
+    break;
   case fnv1a("Stop"):
     handleStop(doc);
     break;
@@ -352,6 +390,36 @@ void CommManager::dispatchCommand(JsonObject doc)
   case fnv1a("GetMaxAccel"):
     handleGetMaxAccel(doc);
     break;
+  case fnv1a("SetMaxJerk"):
+    handleSetMaxJerk(doc);
+    break;
+  case fnv1a("GetMaxJerk"):
+    handleGetMaxJerk(doc);
+    break;
+  case fnv1a("SetMaxJogLag"):
+    handleSetMaxJogLag(doc);
+    break;
+  case fnv1a("GetMaxJogLag"):
+    handleGetMaxJogLag(doc);
+    break;
+  case fnv1a("SetStepTiming"):
+    handleSetStepTiming(doc);
+    break;
+  case fnv1a("GetStepTiming"):
+    handleGetStepTiming(doc);
+    break;
+  case fnv1a("SetBacklash"):
+    handleSetBacklash(doc);
+    break;
+  case fnv1a("GetBacklash"):
+    handleGetBacklash(doc);
+    break;
+  case fnv1a("SetShaper"):
+    handleSetShaper(doc);
+    break;
+  case fnv1a("GetShaper"):
+    handleGetShaper(doc);
+    break;
   case fnv1a("SetHomeOffset"):
     handleSetHomeOffset(doc);
     break;
@@ -376,6 +444,15 @@ void CommManager::dispatchCommand(JsonObject doc)
   case fnv1a("SetVel"):
     handleSetVel(doc);
     break;
+  case fnv1a("SetOverride"):
+    handleSetOverride(doc);
+    break;
+  case fnv1a("GetStepStats"):
+    handleGetStepStats(doc);
+    break;
+  case fnv1a("GetIsrStats"):
+    handleGetIsrStats(doc);
+    break;
   default:
     sendCallback("unknownCmd", false, cmd);
     break;
@@ -434,29 +511,100 @@ void CommManager::handleGetSystemStatus(JsonObject &)
   data["uptime"] = millis();
   data["estop"] = SafetyManager::instance().isEStopped() ? 1 : 0;
   data["homing"] = CalibrationManager::instance().isHoming() ? 1 : 0;
+  data["override"] = JointManager::instance().getOverride();
   attachId(doc);
   String out;
   serializeJson(doc, out);
   _serial->println(out);
 }
 
+// Step-rate headroom per joint: held = ticks a due step had to wait,
+// peak = most steps owed at once, fast = plans above maxSpeed.
+// {"cmd":"GetStepStats","clear":true} resets the counters after reporting.
+void CommManager::handleGetStepStats(JsonObject &doc)
+{
+  auto &sm = StepperManager::instance();
+  StaticJsonDocument<768> pd;
+  pd["cmd"] = "stepStats";
+  auto arr = pd.createNestedArray("data");
+  for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+  {
+    StepperManager::StepStats st;
+    sm.getStepStats(j, st);
+    JsonObject o = arr.createNestedObject();
+    o["joint"] = int(j + 1);
+    o["maxStepRate"] = sm.maxStepRate(j);
+    o["maxSpeed"] = JointManager::instance().getMaxStepSpeed(j);
+    o["held"] = st.heldTicks;
+    o["peak"] = st.peakCarry;
+    o["fast"] = st.fastPlans;
+  }
+  if (doc["clear"].as<bool>())
+    sm.clearStepStats();
+
+  attachId(pd);
+  String out;
+  serializeJson(pd, out);
+  _serial->println(out);
+}
+
+// Step ISR timing since the previous call, in CPU cycles; every call
+// starts a new window. hist[i] counts runs that took i/16 .. (i+1)/16 of
+// the tick budget, the last bin everything above.
+void CommManager::handleGetIsrStats(JsonObject &)
+{
+  IsrStats st;
+  StepperManager::instance().getIsrStats(st, true);
+
+  StaticJsonDocument<768> pd;
+  pd["cmd"] = "isrStats";
+  auto data = pd.createNestedObject("data");
+  data["cpuHz"] = st.cpuHz;
+  data["budget"] = st.budget;
+  data["count"] = st.count;
+  data["min"] = st.count ? st.minCycles : 0;
+  data["max"] = st.maxCycles;
+  data["mean"] = st.count ? float(st.totalCycles) / float(st.count) : 0.0f;
+  data["overruns"] = st.overruns;
+  if (st.maxPeriod)
+  {
+    data["periodMin"] = st.minPeriod;
+    data["periodMax"] = st.maxPeriod;
+    data["jitter"] = st.maxPeriod - st.minPeriod;
+  }
+  auto hist = data.createNestedArray("hist");
+  for (size_t i = 0; i < IsrStats::BINS; ++i)
+    hist.add(st.hist[i]);
+
+  attachId(pd);
+  String out;
+  serializeJson(pd, out);
+  _serial->println(out);
+}
+
 void CommManager::handleGetJointStatus(JsonObject &doc)
 {
   {
     // If no "joint" field, send *all* joints in one array
     if (!doc.containsKey("joint"))
     {
-      StaticJsonDocument<512> pd;
+      // one snapshot: every joint is reported at the same ISR tick
+      JointState st[CONFIG_JOINT_COUNT];
+      uint32_t tick = JointManager::instance().getJointStates(st);
+
+      StaticJsonDocument<768> pd;
       pd["cmd"] = "jointStatusAll";
+      pd["tick"] = tick;
       auto arr = pd.createNestedArray("data");
       for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
       {
         JsonObject o = arr.createNestedObject();
         o["joint"] = int(j + 1);
-        o["position"] = JointManager::instance().getPosition(j);
-        o["velocity"] = JointManager::instance().getSpeed(j);
-        o["acceleration"] = JointManager::instance().getAccel(j);
-        o["target"] = JointManager::instance().getTarget(j);
+        o["position"] = st[j].position;
+        o["velocity"] = st[j].speed;
+        o["acceleration"] = st[j].accel;
+        o["target"] = st[j].target;
+        o["accelLimit"] = st[j].accelLimit;
       }
 
       attachId(pd);
@@ -481,6 +629,7 @@ void CommManager::handleGetJointStatus(JsonObject &doc)
     data["velocity"] = JointManager::instance().getSpeed(j);
     data["acceleration"] = JointManager::instance().getAccel(j);
     data["target"] = JointManager::instance().getTarget(j);
+    data["accelLimit"] = JointManager::instance().getAccelLimit(j);
     attachId(pd);
     String out;
     serializeJson(pd, out);
@@ -501,6 +650,14 @@ void CommManager::handleMoveTo(JsonObject &doc)
   float tgt = doc["target"].as<float>();
   float spd = doc["speed"].as<float>();
   float acc = doc["accel"].as<float>();
+  if (doc["queue"].as<bool>())
+  {
+    // runs after what is already queued; moveDone reports it by id
+    int id = getPendingCmdId();
+    bool ok = JointManager::instance().queueMove(j, tgt, spd, acc, id > 0 ? uint32_t(id) : 0);
+    sendCallback("moveTo", ok, ok ? nullptr : "invalid/full/busy/estop");
+    return;
+  }
   bool ok = JointManager::instance().move(j, tgt, spd, acc);
   sendCallback("moveTo", ok, ok ? nullptr : "invalid/moving/estop");
 }
@@ -554,6 +711,27 @@ void CommManager::handleMoveMultiple(JsonObject &doc)
     accels[i] = acs[i].as<float>();
   }
 
+  // optional: a waypoint of a blended path, passed through without
+  // stopping where the look-ahead allows; moveDone reports it by id
+  if (doc["blend"].as<bool>())
+  {
+    int id = getPendingCmdId();
+    bool ok = JointManager::instance().queuePath(joints, targets, speeds, accels, N,
+                                                 id > 0 ? uint32_t(id) : 0);
+    sendCallback("moveMultiple", ok, ok ? nullptr : "invalid/full/estop");
+    return;
+  }
+
+  // optional: one shared profile so every joint starts/arrives together,
+  // stretched to arrive after `duration` seconds when that is given
+  bool coordinated = doc["coordinated"].as<bool>();
+  float duration = doc["duration"].as<float>();
+  if (doc.containsKey("duration") && !(duration > 0))
+  {
+    sendCallback("moveMultiple", false, "bad duration");
+    return;
+  }
+
   // Fire off all moves in one shot
   bool ok = JointManager::instance()
                 .moveMultiple(joints,
@@ -561,11 +739,13 @@ void CommManager::handleMoveMultiple(JsonObject &doc)
                               speeds,
                               accels,
                               N /* count */,
-                              false /* ignoreLimits? */);
+                              false /* ignoreLimits? */,
+                              coordinated,
+                              duration);
 
   sendCallback("moveMultiple",
                ok,
-               ok ? nullptr : "invalid/moving/estop");
+               ok ? nullptr : (duration > 0 ? "invalid/estop/tooShort" : "invalid/moving/estop"));
 }
 
 void CommManager::handleJog(JsonObject &doc)
@@ -576,6 +756,24 @@ void CommManager::handleJog(JsonObject &doc)
   bool ok = JointManager::instance().jog(j, targetV, accel);
   sendCallback("jog", ok, ok ? nullptr : "invalid/moving/estop");
 }
+
+// Jog onto a position: brakes so the joint stops exactly on the target (or
+// the soft limit short of it); moveDone reports it by id
+void CommManager::handleJogTo(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("jogTo", false, "invalid joint");
+    return;
+  }
+  float tgt = doc["target"].as<float>();
+  float spd = doc["speed"].as<float>();
+  float acc = doc["accel"].as<float>();
+  int id = getPendingCmdId();
+  bool ok = JointManager::instance().jogTo(j, tgt, spd, acc, id > 0 ? uint32_t(id) : 0);
+  sendCallback("jogTo", ok, ok ? nullptr : "invalid/estop");
+}
 void CommManager::handleStop(JsonObject &doc)
 {
   int j = doc["joint"].as<int>() - 1;
@@ -618,6 +816,7 @@ void CommManager::handleSetParam(JsonObject &doc)
   auto &cm = ConfigManager::instance();
   cm.setParameter(k, v);
   cm.saveConfig();
+  JointManager::instance().reloadConfig();
   sendCallback("setParam", true);
 }
 void CommManager::handleGetParam(JsonObject &doc)
@@ -704,12 +903,222 @@ void CommManager::handleGetMaxAccel(JsonObject &doc)
   _serial->println(out);
 }
 
+void CommManager::handleSetMaxJerk(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("setMaxJerk", false, "invalid joint");
+    return;
+  }
+  JointManager::instance().setMaxJerk(j, doc["value"].as<float>());
+  sendCallback("setMaxJerk", true);
+}
+void CommManager::handleGetMaxJerk(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("getMaxJerk", false, "invalid joint");
+    return;
+  }
+  float v = JointManager::instance().getMaxJerk(j);
+
+  StaticJsonDocument<64> pd;
+  pd["cmd"] = "getMaxJerk";
+  pd["data"] = v;
+  attachId(pd);
+  String out;
+  serializeJson(pd, out);
+  _serial->println(out);
+}
+
+void CommManager::handleSetMaxJogLag(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("setMaxJogLag", false, "invalid joint");
+    return;
+  }
+  JointManager::instance().setMaxJogLag(j, doc["value"].as<float>());
+  sendCallback("setMaxJogLag", true);
+}
+void CommManager::handleGetMaxJogLag(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("getMaxJogLag", false, "invalid joint");
+    return;
+  }
+  float v = JointManager::instance().getMaxJogLag(j);
+
+  StaticJsonDocument<64> pd;
+  pd["cmd"] = "getMaxJogLag";
+  pd["data"] = v;
+  attachId(pd);
+  String out;
+  serializeJson(pd, out);
+  _serial->println(out);
+}
+
+// {"cmd":"SetStepTiming","joint":1,"pulseUs":2.5,"dirSetupUs":5}
+// an omitted field keeps its current value
+void CommManager::handleSetStepTiming(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("setStepTiming", false, "invalid joint");
+    return;
+  }
+  float pulseUs, dirSetupUs;
+  JointManager::instance().getStepTiming(j, pulseUs, dirSetupUs);
+  if (doc.containsKey("pulseUs"))
+    pulseUs = doc["pulseUs"].as<float>();
+  if (doc.containsKey("dirSetupUs"))
+    dirSetupUs = doc["dirSetupUs"].as<float>();
+  JointManager::instance().setStepTiming(j, pulseUs, dirSetupUs);
+  sendCallback("setStepTiming", true);
+}
+void CommManager::handleGetStepTiming(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("getStepTiming", false, "invalid joint");
+    return;
+  }
+  float pulseUs, dirSetupUs;
+  JointManager::instance().getStepTiming(j, pulseUs, dirSetupUs);
+
+  StaticJsonDocument<128> pd;
+  pd["cmd"] = "getStepTiming";
+  auto data = pd.createNestedObject("data");
+  data["pulseUs"] = pulseUs;
+  data["dirSetupUs"] = dirSetupUs;
+  attachId(pd);
+  String out;
+  serializeJson(pd, out);
+  _serial->println(out);
+}
+
+// {"cmd":"SetBacklash","joint":2,"backlash":0.12,"speed":2}
+// an omitted field keeps its current value
+void CommManager::handleSetBacklash(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("setBacklash", false, "invalid joint");
+    return;
+  }
+  float deg, speed;
+  JointManager::instance().getBacklash(j, deg, speed);
+  if (doc.containsKey("backlash"))
+    deg = doc["backlash"].as<float>();
+  if (doc.containsKey("speed"))
+    speed = doc["speed"].as<float>();
+  JointManager::instance().setBacklash(j, deg, speed);
+  sendCallback("setBacklash", true);
+}
+void CommManager::handleGetBacklash(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("getBacklash", false, "invalid joint");
+    return;
+  }
+  float deg, speed;
+  JointManager::instance().getBacklash(j, deg, speed);
+
+  StaticJsonDocument<128> pd;
+  pd["cmd"] = "getBacklash";
+  auto data = pd.createNestedObject("data");
+  data["backlash"] = deg;
+  data["speed"] = speed;
+  attachId(pd);
+  String out;
+  serializeJson(pd, out);
+  _serial->println(out);
+}
+
+// {"cmd":"SetShaper","joint":2,"type":"zvd","hz":8.5,"damping":0.05}
+// an omitted field keeps its current value
+void CommManager::handleSetShaper(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("setShaper", false, "invalid joint");
+    return;
+  }
+  ShaperType type;
+  float hz, damping;
+  JointManager::instance().getShaper(j, type, hz, damping);
+  if (doc.containsKey("type"))
+  {
+    const char *name = doc["type"].as<const char *>();
+    size_t n = 0;
+    while (n < sizeof(SHAPER_NAMES) / sizeof(SHAPER_NAMES[0]) && !(name && strcmp(name, SHAPER_NAMES[n]) == 0))
+      ++n;
+    if (n == sizeof(SHAPER_NAMES) / sizeof(SHAPER_NAMES[0]))
+    {
+      sendCallback("setShaper", false, "invalid shaper");
+      return;
+    }
+    type = ShaperType(n);
+  }
+  if (doc.containsKey("hz"))
+    hz = doc["hz"].as<float>();
+  if (doc.containsKey("damping"))
+    damping = doc["damping"].as<float>();
+  InputShaper shaper;
+  if (!shaper.design(type, hz, damping) || shaper.duration() > StepperManager::MAX_SHAPER_SEC)
+  {
+    sendCallback("setShaper", false, "invalid shaper");
+    return;
+  }
+  if (!JointManager::instance().setShaper(j, type, hz, damping))
+  {
+    sendCallback("setShaper", false, "joint moving");
+    return;
+  }
+  sendCallback("setShaper", true);
+}
+void CommManager::handleGetShaper(JsonObject &doc)
+{
+  int j = doc["joint"].as<int>() - 1;
+  if (j < 0 || j >= CONFIG_JOINT_COUNT)
+  {
+    sendCallback("getShaper", false, "invalid joint");
+    return;
+  }
+  ShaperType type;
+  float hz, damping;
+  JointManager::instance().getShaper(j, type, hz, damping);
+
+  StaticJsonDocument<128> pd;
+  pd["cmd"] = "getShaper";
+  auto data = pd.createNestedObject("data");
+  data["type"] = uint8_t(type) < sizeof(SHAPER_NAMES) / sizeof(SHAPER_NAMES[0]) ? SHAPER_NAMES[uint8_t(type)] : "none";
+  data["hz"] = hz;
+  data["damping"] = damping;
+  attachId(pd);
+  String out;
+  serializeJson(pd, out);
+  _serial->println(out);
+}
+
 void CommManager::handleSetHomeOffset(JsonObject &doc)
 {
   int j = doc["joint"].as<int>() - 1;
   float off = doc["value"].as<float>();
   String key = String("joint") + String(j + 1) + ".homeOffset";
   ConfigManager::instance().setParameter(key.c_str(), off);
+  JointManager::instance().reloadConfig(j);
   sendCallback("setHomeOffset", true);
 }
 
@@ -767,6 +1176,7 @@ void CommManager::handleSetPositionFactor(JsonObject &doc)
   float f = doc["value"].as<float>();
   String key = String("joint") + String(j + 1) + ".positionFactor";
   ConfigManager::instance().setParameter(key.c_str(), f);
+  JointManager::instance().reloadConfig(j);
   sendCallback("setPositionFactor", true);
 }
 void CommManager::handleGetPositionFactor(JsonObject &doc)
@@ -808,24 +1218,31 @@ void CommManager::handleOutput(JsonObject &doc)
 // ——— SetVel: live 20 ms velocity setpoint for streaming linear moves ———
 void CommManager::handleSetVel(JsonObject &doc)
 {
-  auto arrS = doc["s"].as<JsonArray>();
-  auto arrA = doc["a"].as<JsonArray>();
-  if (arrS.size() != CONFIG_JOINT_COUNT || arrA.size() != CONFIG_JOINT_COUNT)
+  float speeds[CONFIG_JOINT_COUNT]; // signed deg/s — direction in sign
+  float accels[CONFIG_JOINT_COUNT];
+  if (!readAxisArray(doc["s"], speeds) || !readAxisArray(doc["a"], accels))
   {
     sendCallback("SetVel", false, "badLength");
     return;
   }
-  float speeds[CONFIG_JOINT_COUNT];
-  float accels[CONFIG_JOINT_COUNT];
   for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
-  {
-    speeds[j] = arrS[j].as<float>();          // signed deg/s — direction in sign
-    accels[j] = fabsf(arrA[j].as<float>());   // magnitude deg/s²
-  }
+    accels[j] = fabsf(accels[j]); // magnitude deg/s²
   JointManager::instance().feedVelocitySlice(speeds, accels);
   sendCallback("SetVel", true);
 }
 
+// ——— SetOverride: feed-rate override for running moves and batches ———
+void CommManager::handleSetOverride(JsonObject &doc)
+{
+  float scale = doc["scale"].as<float>();
+  if (!JointManager::instance().setOverride(scale))
+  {
+    sendCallback("SetOverride", false, "invalid scale");
+    return;
+  }
+  sendCallback("SetOverride", true);
+}
+
 // ——— Convenience —————————————————————————————————
 
 void CommManager::sendError(const char *errMsg)
@@ -868,6 +1285,26 @@ void CommManager::sendInputStatus()
   _serial->println(out);
 }
 
+void CommManager::sendFinishedMoves()
+{
+  size_t joint;
+  uint32_t id;
+  while (JointManager::instance().takeFinishedMove(joint, id))
+  {
+    StaticJsonDocument<96> doc;
+    doc["cmd"] = "moveDone";
+    JsonObject data = doc.createNestedObject("data");
+    if (joint == StepperManager::FINISHED_PATH)
+      data["path"] = true;
+    else
+      data["joint"] = int(joint + 1);
+    doc["id"] = id;
+    String out;
+    serializeJson(doc, out);
+    _serial->println(out);
+  }
+}
+
 void CommManager::sendHomingResponse(size_t joint, float minPos, float maxPos)
 {
   StaticJsonDocument<128> doc;
@@ -897,6 +1334,7 @@ void CommManager::sendJointStatus(size_t joint)
   data["velocity"] = JointManager::instance().getSpeed(joint);
   data["acceleration"] = JointManager::instance().getAccel(joint);
   data["target"] = JointManager::instance().getTarget(joint);
+  data["accelLimit"] = JointManager::instance().getAccelLimit(joint);
   attachId(doc);
   String out;
   serializeJson(doc, out);
@@ -911,6 +1349,7 @@ void CommManager::sendSystemStatus()
   data["uptimeSec"] = millis() / 1000; // seconds since boot
   data["estop"] = SafetyManager::instance().isEStopped() ? 1 : 0;
   data["homing"] = CalibrationManager::instance().isHoming() ? 1 : 0;
+  data["override"] = JointManager::instance().getOverride();
   attachId(doc);
   String out;
   serializeJson(doc, out);
@@ -43,6 +43,7 @@ public:
   State state() const { return _state; }
   void sendInputStatus();
   void sendHomingResponse(size_t joint, float minPos, float maxPos);
+  void sendFinishedMoves();
   void sendJointStatus(size_t joint);
   void sendSystemStatus();
   void sendError(const char *errMsg);
@@ -89,6 +90,7 @@ private:
   void handleMoveBy(JsonObject &doc);
   void handleMoveMultiple(JsonObject &doc);
   void handleJog(JsonObject &doc);
+  void handleJogTo(JsonObject &doc);
   void handleStop(JsonObject &doc);
   void handleStopAll(JsonObject &doc);
   void handleHome(JsonObject &doc);
@@ -102,6 +104,16 @@ private:
   void handleGetMaxSpeed(JsonObject &doc);
   void handleSetMaxAccel(JsonObject &doc);
   void handleGetMaxAccel(JsonObject &doc);
+  void handleSetMaxJerk(JsonObject &doc);
+  void handleGetMaxJerk(JsonObject &doc);
+  void handleSetMaxJogLag(JsonObject &doc);
+  void handleGetMaxJogLag(JsonObject &doc);
+  void handleSetStepTiming(JsonObject &doc);
+  void handleGetStepTiming(JsonObject &doc);
+  void handleSetBacklash(JsonObject &doc);
+  void handleGetBacklash(JsonObject &doc);
+  void handleSetShaper(JsonObject &doc);
+  void handleGetShaper(JsonObject &doc);
   void handleSetHomeOffset(JsonObject &doc);
   void handleGetHomeOffset(JsonObject &doc);
   void handleSetPositionFactor(JsonObject &doc);
@@ -110,6 +122,9 @@ private:
   void handleRestart(JsonObject &doc);
   void handleListParameters(JsonObject &doc);
   void handleSetVel(JsonObject &doc);
+  void handleSetOverride(JsonObject &doc);
+  void handleGetStepStats(JsonObject &doc);
+  void handleGetIsrStats(JsonObject &doc);
 
   static constexpr size_t VP_RX_BUF_SIZE = 512U;
   static char rxBuffer[VP_RX_BUF_SIZE];
@@ -119,6 +134,8 @@ private:
   // batch timing
   uint32_t _dtUs = 0;
   uint32_t _lastExecUs = 0;
+  float _batchScale = 1.0f;    // time scale the last sub-step runs at (override and speed limiter)
+  float _batchOverride = 1.0f; // feed override the sub-step clock has slewed to
 };
 
 // Exposed to other .cpp
@@ -127,5 +144,6 @@ extern size_t _segIndex;
 extern float _dtSec;
 extern float _prevSpeeds[CONFIG_JOINT_COUNT];
 extern float _accelPerSub[CONFIG_JOINT_COUNT];
+extern float _segAccel[CONFIG_JOINT_COUNT];
 
 #endif // COMM_MANAGER_H
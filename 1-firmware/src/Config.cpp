@@ -25,7 +25,16 @@ const JointConfig JOINT_CONFIG[CONFIG_JOINT_COUNT] = {
         STEPPER_DIR_PINS[0],   // 13) dirPin
         0,                     // 14) unused (pad)
         25.0f,                 // 18) maxJointSpeed (deg/s)
-        3.3333f                // 19) positionFactor
+        3.3333f,               // 19) positionFactor
+        500.0f,                // 20) maxJerk (deg/s³)
+        0.02f,                 // 21) maxJogLag (s)
+        3.0f,                  // 22) stepPulseUs (µs)
+        5.0f,                  // 23) dirSetupUs (µs)
+        0.0f,                  // 24) backlash (deg, 0 = none)
+        3.0f,                  // 25) backlashSpeed (deg/s)
+        0,                     // 26) shaper (0 none, 1 ZV, 2 ZVD, 3 EI)
+        0.0f,                  // 27) shaperHz (0 = not measured)
+        0.05f                  // 28) shaperDamping
     },
 
     // — J2 —
@@ -45,7 +54,16 @@ const JointConfig JOINT_CONFIG[CONFIG_JOINT_COUNT] = {
         STEPPER_DIR_PINS[1],          // 13) dirPin
         0,                            // 14) unused (pad)
         60.0f,                        // 18) maxJointSpeed (deg/s)
-        0.8333f                       // 19) positionFactor
+        0.8333f,                      // 19) positionFactor
+        500.0f,                       // 20) maxJerk (deg/s³)
+        0.02f,                        // 21) maxJogLag (s)
+        3.0f,                         // 22) stepPulseUs (µs)
+        5.0f,                         // 23) dirSetupUs (µs)
+        0.0f,                         // 24) backlash (deg, 0 = none)
+        2.0f,                         // 25) backlashSpeed (deg/s)
+        0,                            // 26) shaper (0 none, 1 ZV, 2 ZVD, 3 EI)
+        0.0f,                         // 27) shaperHz (0 = not measured)
+        0.05f                         // 28) shaperDamping
     },
 
     // — J3 —
@@ -65,7 +83,16 @@ const JointConfig JOINT_CONFIG[CONFIG_JOINT_COUNT] = {
         STEPPER_DIR_PINS[2],          // 13) dirPin
         0,                            // 14) unused (pad)
         80.0f,                        // 18) maxJointSpeed (deg/s)
-        0.8804f                       // 19) positionFactor
+        0.8804f,                      // 19) positionFactor
+        3000.0f,                      // 20) maxJerk (deg/s³)
+        0.02f,                        // 21) maxJogLag (s)
+        3.0f,                         // 22) stepPulseUs (µs)
+        5.0f,                         // 23) dirSetupUs (µs)
+        0.0f,                         // 24) backlash (deg, 0 = none)
+        2.0f,                         // 25) backlashSpeed (deg/s)
+        0,                            // 26) shaper (0 none, 1 ZV, 2 ZVD, 3 EI)
+        0.0f,                         // 27) shaperHz (0 = not measured)
+        0.05f                         // 28) shaperDamping
     },
     // — J4 —
     {
@@ -84,7 +111,16 @@ const JointConfig JOINT_CONFIG[CONFIG_JOINT_COUNT] = {
         STEPPER_DIR_PINS[3],   // 13) dirPin
         0,                     // 14) unused (pad)
         150.0f,                // 18) maxJointSpeed (deg/s)
-        1.0f                   // 19) positionFactor
+        1.0f,                  // 19) positionFactor
+        36000.0f,              // 20) maxJerk (deg/s³)
+        0.02f,                 // 21) maxJogLag (s)
+        3.0f,                  // 22) stepPulseUs (µs)
+        5.0f,                  // 23) dirSetupUs (µs)
+        0.0f,                  // 24) backlash (deg, 0 = none)
+        3.0f,                  // 25) backlashSpeed (deg/s)
+        0,                     // 26) shaper (0 none, 1 ZV, 2 ZVD, 3 EI)
+        0.0f,                  // 27) shaperHz (0 = not measured)
+        0.05f                  // 28) shaperDamping
 
     },
     // — J5 —
@@ -104,7 +140,16 @@ const JointConfig JOINT_CONFIG[CONFIG_JOINT_COUNT] = {
         STEPPER_DIR_PINS[4],   // 13) dirPin
         0,                     // 14) unused (pad)
         250.0f,                // 18) maxJointSpeed (deg/s)
-        0.8411f                // 19) positionFactor
+        0.8411f,               // 19) positionFactor
+        5000.0f,               // 20) maxJerk (deg/s³)
+        0.02f,                 // 21) maxJogLag (s)
+        3.0f,                  // 22) stepPulseUs (µs)
+        5.0f,                  // 23) dirSetupUs (µs)
+        0.0f,                  // 24) backlash (deg, 0 = none)
+        3.0f,                  // 25) backlashSpeed (deg/s)
+        0,                     // 26) shaper (0 none, 1 ZV, 2 ZVD, 3 EI)
+        0.0f,                  // 27) shaperHz (0 = not measured)
+        0.05f                  // 28) shaperDamping
     },
     // — J6 —
     {
@@ -123,8 +168,79 @@ const JointConfig JOINT_CONFIG[CONFIG_JOINT_COUNT] = {
         STEPPER_DIR_PINS[5],   // 13) dirPin
         0,                     // 14) unused (pad)
         700.0f,                // 18) maxJointSpeed (deg/s)
-        1.0f                   // 19) positionFactor
-    }};
+        1.0f,                  // 19) positionFactor
+        112000.0f,             // 20) maxJerk (deg/s³)
+        0.02f,                 // 21) maxJogLag (s)
+        3.0f,                  // 22) stepPulseUs (µs)
+        5.0f,                  // 23) dirSetupUs (µs)
+        0.0f,                  // 24) backlash (deg, 0 = none)
+        3.0f,                  // 25) backlashSpeed (deg/s)
+        0,                     // 26) shaper (0 none, 1 ZV, 2 ZVD, 3 EI)
+        0.0f,                  // 27) shaperHz (0 = not measured)
+        0.05f                  // 28) shaperDamping
+    },
+#if EXTERNAL_AXES >= 1
+    // — J7: linear track, units are mm —
+    // gearboxRatio = 360 / mm of travel per motor turn (GT2 20T pulley: 40 mm)
+    {
+        "J7",                  //  1) name
+        600.0f,                //  2) maxMotorSpeed
+        360.0f / 40.0f,        //  3) gearboxRatio
+        1600,                  //  4) stepsPerRev
+        500.0f,                //  5) maxAcceleration (mm/s²)
+        20.0f,                 //  6) homingSpeed (mm/s)
+        5.0f,                  //  7) slowHomingSpeed (mm/s)
+        0.0f,                  //  8) jointMin (mm)
+        1000.0f,               //  9) jointMax (mm)
+        0.0f,                  // 10) homeOffset (mm)
+        false,                 // 11) isReversed
+        STEPPER_PULSE_PINS[6], // 12) pulsePin
+        STEPPER_DIR_PINS[6],   // 13) dirPin
+        0,                     // 14) unused (pad)
+        250.0f,                // 18) maxJointSpeed (mm/s)
+        1.0f,                  // 19) positionFactor
+        5000.0f,               // 20) maxJerk (mm/s³)
+        0.02f,                 // 21) maxJogLag (s)
+        3.0f,                  // 22) stepPulseUs (µs)
+        5.0f,                  // 23) dirSetupUs (µs)
+        0.0f,                  // 24) backlash (mm, 0 = none)
+        5.0f,                  // 25) backlashSpeed (mm/s)
+        0,                     // 26) shaper (0 none, 1 ZV, 2 ZVD, 3 EI)
+        0.0f,                  // 27) shaperHz (0 = not measured)
+        0.05f                  // 28) shaperDamping
+    },
+#endif
+#if EXTERNAL_AXES >= 2
+    // — J8: rotary table —
+    {
+        "J8",                  //  1) name
+        600.0f,                //  2) maxMotorSpeed
+        10.0f,                 //  3) gearboxRatio
+        1600,                  //  4) stepsPerRev
+        90.0f,                 //  5) maxAcceleration
+        15.0f,                 //  6) homingSpeed
+        3.0f,                  //  7) slowHomingSpeed
+        0.0f,                  //  8) jointMin
+        360.0f,                //  9) jointMax
+        0.0f,                  // 10) homeOffset
+        false,                 // 11) isReversed
+        STEPPER_PULSE_PINS[7], // 12) pulsePin
+        STEPPER_DIR_PINS[7],   // 13) dirPin
+        0,                     // 14) unused (pad)
+        90.0f,                 // 18) maxJointSpeed (deg/s)
+        1.0f,                  // 19) positionFactor
+        2000.0f,               // 20) maxJerk (deg/s³)
+        0.02f,                 // 21) maxJogLag (s)
+        3.0f,                  // 22) stepPulseUs (µs)
+        5.0f,                  // 23) dirSetupUs (µs)
+        0.0f,                  // 24) backlash (deg, 0 = none)
+        3.0f,                  // 25) backlashSpeed (deg/s)
+        0,                     // 26) shaper (0 none, 1 ZV, 2 ZVD, 3 EI)
+        0.0f,                  // 27) shaperHz (0 = not measured)
+        0.05f                  // 28) shaperDamping
+    },
+#endif
+};
 // ————————————————————————————————————————————————
 // 2) Buttons + E-stop (activeLow, debounce)
 // ————————————————————————————————————————————————
@@ -146,13 +262,19 @@ const DigitalInputConfig DIGITAL_INPUT_CONFIG[DIGITAL_INPUT_COUNT_CFG] = {
     // — E-Stop —
     {"E-Stop", PIN_ESTOP, false, 20},
 
-    // — Limit switches J1…J6 —
+    // — Limit switches, one per axis —
     {"Limit J1", LIMIT_PINS[0], true, 10},
     {"Limit J2", LIMIT_PINS[1], true, 10},
     {"Limit J3", LIMIT_PINS[2], true, 10},
     {"Limit J4", LIMIT_PINS[3], true, 10},
     {"Limit J5", LIMIT_PINS[4], true, 10},
     {"Limit J6", LIMIT_PINS[5], true, 2},
+#if EXTERNAL_AXES >= 1
+    {"Limit J7", LIMIT_PINS[6], true, 10},
+#endif
+#if EXTERNAL_AXES >= 2
+    {"Limit J8", LIMIT_PINS[7], true, 10},
+#endif
 };
 
 // ————————————————————————————————————————————————
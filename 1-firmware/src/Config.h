@@ -27,11 +27,27 @@ struct JointConfig
   uint8_t unused;        // 14) _pad_ (to keep struct sizeof alignment; you can repurpose or remove if you like)
   float maxJointSpeed;   // 15) max joint speed (deg/s)
   float positionFactor;  // 18) scale factor for real joint output
+  float maxJerk;         // 20) deg/s³ (0 = trapezoidal moves, linear jog slew)
+  float maxJogLag;       // 21) s, jog jerk is raised so slewing lags no more than this
+  float stepPulseUs;     // 22) µs step high time (also the min low time)
+  float dirSetupUs;      // 23) µs dir must be stable before a step edge
+  float backlash;        // 24) deg of play taken up after a reversal (0 = none)
+  float backlashSpeed;   // 25) deg/s the take-up steps run at
+  uint8_t shaper;        // 26) input shaper (ShaperType: 0 none, 1 ZV, 2 ZVD, 3 EI)
+  float shaperHz;        // 27) Hz of the vibration it cancels
+  float shaperDamping;   // 28) damping ratio of that vibration
 };
 
 constexpr size_t CONFIG_JOINT_COUNT = STEPPER_COUNT;
 extern const JointConfig JOINT_CONFIG[CONFIG_JOINT_COUNT];
 
+// === Blended paths (look-ahead), overridable as path.deviation / path.window ===
+constexpr float PATH_DEVIATION_DEFAULT = 0.05f; // deg of joint space a corner may be cut by
+constexpr size_t PATH_WINDOW_DEFAULT = 16;      // waypoints planned ahead
+
+// === Pose-scheduled accel (ArmModel), overridable as accel.scheduleMax ===
+constexpr float ACCEL_SCHEDULE_MAX_DEFAULT = 3.0f; // most J1..J3 maxAcceleration may grow by (1 = off)
+
 // === Buttons + E-Stop + Limit Switches ===
 struct DigitalInputConfig
 {
@@ -41,7 +57,7 @@ struct DigitalInputConfig
   uint32_t debounceMs;
 };
 
-// now: 12 buttons + 1 E-stop + 6 limit switches
+// now: 12 buttons + 1 E-stop + one limit switch per axis
 constexpr size_t DIGITAL_INPUT_COUNT_CFG = BUTTON_COUNT + 1 + LIMIT_COUNT;
 extern const DigitalInputConfig DIGITAL_INPUT_CONFIG[DIGITAL_INPUT_COUNT_CFG];
 
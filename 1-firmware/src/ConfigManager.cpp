@@ -74,6 +74,24 @@ void ConfigManager::resetConfigToDefaults()
         _doc[key] = JOINT_CONFIG[i].positionFactor;
         snprintf(key, sizeof(key), "joint%u.maxAccel", unsigned(i + 1));
         _doc[key] = JOINT_CONFIG[i].maxAcceleration;
+        snprintf(key, sizeof(key), "joint%u.maxJerk", unsigned(i + 1));
+        _doc[key] = JOINT_CONFIG[i].maxJerk;
+        snprintf(key, sizeof(key), "joint%u.maxJogLag", unsigned(i + 1));
+        _doc[key] = JOINT_CONFIG[i].maxJogLag;
+        snprintf(key, sizeof(key), "joint%u.stepPulseUs", unsigned(i + 1));
+        _doc[key] = JOINT_CONFIG[i].stepPulseUs;
+        snprintf(key, sizeof(key), "joint%u.dirSetupUs", unsigned(i + 1));
+        _doc[key] = JOINT_CONFIG[i].dirSetupUs;
+        snprintf(key, sizeof(key), "joint%u.backlash", unsigned(i + 1));
+        _doc[key] = JOINT_CONFIG[i].backlash;
+        snprintf(key, sizeof(key), "joint%u.backlashSpeed", unsigned(i + 1));
+        _doc[key] = JOINT_CONFIG[i].backlashSpeed;
+        snprintf(key, sizeof(key), "joint%u.shaper", unsigned(i + 1));
+        _doc[key] = JOINT_CONFIG[i].shaper;
+        snprintf(key, sizeof(key), "joint%u.shaperHz", unsigned(i + 1));
+        _doc[key] = JOINT_CONFIG[i].shaperHz;
+        snprintf(key, sizeof(key), "joint%u.shaperDamping", unsigned(i + 1));
+        _doc[key] = JOINT_CONFIG[i].shaperDamping;
         snprintf(key, sizeof(key), "joint%u.maxSpeed", unsigned(i + 1));
         _doc[key] = JOINT_CONFIG[i].maxJointSpeed;
         snprintf(key, sizeof(key), "joint%u.homingSpeed", unsigned(i + 1));
@@ -96,7 +96,7 @@ bool IOManager::isReady()
 
 bool IOManager::isLimitActive(size_t limitIdx) const
 {
-    // limitIdx: 0..5 → BUTTON_COUNT+1+limitIdx
+    // limitIdx: 0..LIMIT_COUNT-1 → BUTTON_COUNT+1+limitIdx
     size_t idx = BUTTON_COUNT + 1 + limitIdx;
     return isDigitalActive(idx);
 }
@@ -17,7 +17,7 @@ public:
 
   /// Read debounced button/limit/E-stop
   bool isDigitalActive(size_t idx) const;
-  /// Convenience: 0..5 → limit switches J1..J6
+  /// Convenience: 0..LIMIT_COUNT-1 → limit switches J1..JN
   bool isLimitActive(size_t limitIdx) const;
 
   /// Drive one of the outputs (0-based index into RELAY_CONFIG)
@@ -0,0 +1,115 @@
+#ifndef ISR_PROFILER_H
+#define ISR_PROFILER_H
+
+#include <Arduino.h>
+
+// Free-running cycle counter the ISR profiler reads at entry and exit.
+#ifdef ARDUINO
+struct CycleClock
+{
+    static inline void begin()
+    {
+        ARM_DEMCR |= ARM_DEMCR_TRCENA;
+        ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+    }
+    static inline uint32_t now() { return ARM_DWT_CYCCNT; }
+    static inline uint32_t hz() { return F_CPU_ACTUAL; }
+};
+#else
+// Host build: the clock is whatever a test says it is. Point source at a
+// simulated counter (or set cycles by hand) to drive the profiler.
+struct CycleClock
+{
+    inline static uint32_t cycles = 0;
+    inline static uint32_t rate = 600000000;
+    inline static uint32_t (*source)() = nullptr;
+
+    static inline void begin() {}
+    static inline uint32_t now() { return source ? source() : cycles; }
+    static inline uint32_t hz() { return rate; }
+};
+#endif
+
+// Execution time of an interrupt handler against its tick budget (cycles
+// per tick): min/max/mean, a histogram in sixteenths of the budget, and
+// for a periodic handler the spread of entry-to-entry times.
+struct IsrStats
+{
+    static constexpr size_t BINS = 16;
+
+    uint32_t cpuHz;       // cycle counter rate
+    uint32_t budget;      // cycles per tick
+    uint32_t count;       // handler runs recorded
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t hist[BINS];  // bin i: i/16 to (i+1)/16 of the budget, last bin open-ended
+    uint32_t overruns;    // runs that took a whole tick or more
+    uint32_t minPeriod;   // entry to entry, periodic handlers only (0 otherwise)
+    uint32_t maxPeriod;
+};
+
+class IsrProfiler
+{
+public:
+    // periodic: the handler runs once per tick, so entry spacing is jitter
+    void begin(uint32_t budget, bool periodic)
+    {
+        CycleClock::begin();
+        _budget = budget ? budget : 1;
+        _binWidth = (_budget + IsrStats::BINS - 1) / IsrStats::BINS;
+        _periodic = periodic;
+        _haveLast = false;
+        reset();
+    }
+
+    void reset()
+    {
+        _s = {};
+        _s.cpuHz = CycleClock::hz();
+        _s.budget = _budget;
+        _s.minCycles = UINT32_MAX;
+        _s.minPeriod = _periodic ? UINT32_MAX : 0;
+    }
+
+    inline void record(uint32_t start, uint32_t end)
+    {
+        uint32_t d = end - start;
+        ++_s.count;
+        _s.totalCycles += d;
+        if (d < _s.minCycles)
+            _s.minCycles = d;
+        if (d > _s.maxCycles)
+            _s.maxCycles = d;
+        uint32_t bin = d / _binWidth;
+        ++_s.hist[bin < IsrStats::BINS ? bin : IsrStats::BINS - 1];
+        if (d >= _budget)
+            ++_s.overruns;
+
+        if (!_periodic)
+            return;
+        if (_haveLast)
+        {
+            uint32_t p = start - _lastStart;
+            if (p < _s.minPeriod)
+                _s.minPeriod = p;
+            if (p > _s.maxPeriod)
+                _s.maxPeriod = p;
+        }
+        _lastStart = start;
+        _haveLast = true;
+    }
+
+    // Copy with the handler masked out by the caller
+    const IsrStats &stats() const { return _s; }
+
+private:
+    IsrStats _s = {};
+    uint32_t _budget = 1;
+    uint32_t _binWidth = 1;
+    uint32_t _lastStart = 0;
+    bool _periodic = false;
+    bool _haveLast = false;
+};
+
+#endif // ISR_PROFILER_H
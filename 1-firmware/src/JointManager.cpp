@@ -1,5 +1,6 @@
 #include "JointManager.h"
 #include "SafetyManager.h"
+#include "ArmModel.h"
 #include <cmath>
 
 JointManager &JointManager::instance()
@@ -21,6 +22,17 @@ void JointManager::begin()
 }
 
 bool JointManager::move(size_t joint, float targetDeg, float vMaxDegPerSec, float aMaxDegPerSec2, bool ignoreLimits)
+{
+    if (!_stageMove(joint, targetDeg, vMaxDegPerSec, aMaxDegPerSec2, ignoreLimits))
+    {
+        StepperManager::instance().stageDiscard();
+        return false;
+    }
+    return StepperManager::instance().commit();
+}
+
+// Plan one joint's move into the StepperManager stage (no commit)
+bool JointManager::_stageMove(size_t joint, float targetDeg, float vMaxDegPerSec, float aMaxDegPerSec2, bool ignoreLimits)
 {
     if (joint >= CONFIG_JOINT_COUNT || SafetyManager::instance().isEStopped())
         return false;
@@ -39,8 +51,33 @@ bool JointManager::move(size_t joint, float targetDeg, float vMaxDegPerSec, floa
     long deltaSteps = lroundf(deltaDeg * _cache[joint].stepsPerPhysDeg);
     float vStepsPerSec = fabsf(vMaxDegPerSec) * _cache[joint].stepsPerPhysDeg;
     float aStepsPerSec2 = fabsf(aMaxDegPerSec2) * _cache[joint].stepsPerPhysDeg;
+    float jStepsPerSec3 = _cache[joint].cfgMaxJerk * _cache[joint].stepsPerPhysDeg;
 
-    return StepperManager::instance().startMotion(joint, deltaSteps, vStepsPerSec, aStepsPerSec2);
+    return StepperManager::instance().stageMotion(joint, deltaSteps, vStepsPerSec, aStepsPerSec2, jStepsPerSec3);
+}
+
+bool JointManager::queueMove(size_t joint, float targetDeg, float vMaxDegPerSec, float aMaxDegPerSec2,
+                             uint32_t id)
+{
+    if (joint >= CONFIG_JOINT_COUNT || SafetyManager::instance().isEStopped())
+        return false;
+
+    _reloadCache(joint);
+    const auto &c = _cache[joint];
+    if (targetDeg < c.userMinDeg || targetDeg > c.userMaxDeg)
+        return false;
+
+    int64_t targetSteps = llroundf(targetDeg * c.stepsPerPhysDeg);
+    return StepperManager::instance().queueMotion(joint, targetSteps,
+                                                  fabsf(vMaxDegPerSec) * c.stepsPerPhysDeg,
+                                                  fabsf(aMaxDegPerSec2) * c.stepsPerPhysDeg,
+                                                  c.cfgMaxJerk * c.stepsPerPhysDeg,
+                                                  id);
+}
+
+bool JointManager::takeFinishedMove(size_t &joint, uint32_t &id)
+{
+    return StepperManager::instance().takeFinishedMove(joint, id);
 }
 
 bool JointManager::moveMultiple(const size_t *joints,
@@ -48,8 +85,15 @@ bool JointManager::moveMultiple(const size_t *joints,
                                 const float *speeds,
                                 const float *accels,
                                 size_t count,
-                                bool ignoreLimits)
+                                bool ignoreLimits,
+                                bool coordinated,
+                                float durationSec)
 {
+    // a duration only makes sense when every joint follows one profile
+    if (coordinated || durationSec > 0)
+        return _moveCoordinated(joints, targets, speeds, accels, count, ignoreLimits, durationSec);
+
+    // every valid joint is staged, then all of them start on the same tick
     bool allOk = true;
     for (size_t i = 0; i < count; ++i)
     {
@@ -59,25 +103,142 @@ bool JointManager::moveMultiple(const size_t *joints,
             allOk = false;
             continue;
         }
-        bool ok = move(j, targets[i], speeds[i], accels[i], ignoreLimits);
+        bool ok = _stageMove(j, targets[i], speeds[i], accels[i], ignoreLimits);
         allOk &= ok;
     }
+    StepperManager::instance().commit();
     return allOk;
 }
 
-bool JointManager::jog(size_t joint, float targetDegPerSec, float accelDegPerSec2)
+// All listed joints share one master profile and arrive together; the
+// per-joint speed/accel act as limits. durationSec > 0 slows the master to
+// arrive that many seconds after the start. Any invalid joint, or a duration
+// the limits cannot meet, rejects the move.
+bool JointManager::_moveCoordinated(const size_t *joints,
+                                    const float *targets,
+                                    const float *speeds,
+                                    const float *accels,
+                                    size_t count,
+                                    bool ignoreLimits,
+                                    float durationSec)
+{
+    if (SafetyManager::instance().isEStopped())
+        return false;
+
+    long deltaSteps[CONFIG_JOINT_COUNT] = {0};
+    float vSteps[CONFIG_JOINT_COUNT] = {0};
+    float aSteps[CONFIG_JOINT_COUNT] = {0};
+    float jSteps[CONFIG_JOINT_COUNT] = {0};
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t j = joints[i];
+        if (j >= CONFIG_JOINT_COUNT)
+            return false;
+        _reloadCache(j);
+        if (!ignoreLimits &&
+            (targets[i] < _cache[j].userMinDeg || targets[i] > _cache[j].userMaxDeg))
+            return false;
+
+        float deltaDeg = targets[i] - getPosition(j);
+        deltaSteps[j] = lroundf(deltaDeg * _cache[j].stepsPerPhysDeg);
+        vSteps[j] = fabsf(speeds[i]) * _cache[j].stepsPerPhysDeg;
+        aSteps[j] = fabsf(accels[i]) * _cache[j].stepsPerPhysDeg;
+        jSteps[j] = _cache[j].cfgMaxJerk * _cache[j].stepsPerPhysDeg;
+    }
+    return StepperManager::instance().startCoordinated(deltaSteps, vSteps, aSteps, jSteps, durationSec);
+}
+
+// Speeds/accels are limits along the block, capped by the joint's own
+// maximum (accel: scaled for the poses the block passes through) and what
+// its step line can emit
+bool JointManager::queuePath(const size_t *joints,
+                             const float *targets,
+                             const float *speeds,
+                             const float *accels,
+                             size_t count,
+                             uint32_t id)
+{
+    if (SafetyManager::instance().isEStopped())
+        return false;
+
+    PathPlanner::Waypoint w = {};
+    int64_t from[CONFIG_JOINT_COUNT];
+    float lo[CONFIG_JOINT_COUNT], hi[CONFIG_JOINT_COUNT];
+    _path.endPosition(from);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        _reloadCache(j);
+        w.stepsPerDeg[j] = _cache[j].stepsPerPhysDeg;
+        lo[j] = hi[j] = float(from[j]) / w.stepsPerDeg[j];
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t j = joints[i];
+        if (j >= CONFIG_JOINT_COUNT)
+            return false;
+        const auto &c = _cache[j];
+        if (targets[i] < c.userMinDeg || targets[i] > c.userMaxDeg)
+            return false;
+        w.joints |= 1UL << j;
+        w.target[j] = llroundf(targets[i] * c.stepsPerPhysDeg);
+        w.speed[j] = fminf(fminf(fabsf(speeds[i]), c.cfgMaxSpeed), getMaxStepSpeed(j));
+        w.accel[j] = fabsf(accels[i]);
+        lo[j] = fminf(lo[j], targets[i]);
+        hi[j] = fmaxf(hi[j], targets[i]);
+    }
+    float limit[CONFIG_JOINT_COUNT];
+    _accelLimits(lo, hi, limit);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        w.accel[j] = fminf(w.accel[j], limit[j]);
+    w.id = id;
+
+    auto &cm = ConfigManager::instance();
+    float deviation = cm.getParameter("path.deviation", PATH_DEVIATION_DEFAULT);
+    float window = cm.getParameter("path.window", float(PATH_WINDOW_DEFAULT));
+    _pathWindow = size_t(fminf(fmaxf(window, 1.0f), float(PathPlanner::MAX_WINDOW)));
+    return _path.add(w, fmaxf(deviation, 0.0f), _pathWindow, millis());
+}
+
+void JointManager::servicePath()
+{
+    _path.service(_pathWindow, millis());
+}
+
+bool JointManager::jog(size_t joint, float targetDegPerSec, float accelDegPerSec2, bool ignoreLimits)
 {
     if (joint >= CONFIG_JOINT_COUNT || SafetyManager::instance().isEStopped())
         return false;
     _reloadCache(joint);
 
-    float vStepsPerSec = fabsf(targetDegPerSec) * _cache[joint].stepsPerPhysDeg;
+    float vStepsPerSec = targetDegPerSec * _cache[joint].stepsPerPhysDeg; // signed
     float aStepsPerSec2 = fabsf(accelDegPerSec2) * _cache[joint].stepsPerPhysDeg;
 
-    return StepperManager::instance().startJog(joint,
-                                               (targetDegPerSec >= 0 ? +1 : -1),
-                                               vStepsPerSec,
-                                               aStepsPerSec2);
+    // retargets a running jog in place, reversing through zero if needed
+    StepperManager::instance().setJogTarget(joint,
+                                            vStepsPerSec,
+                                            aStepsPerSec2,
+                                            _jogJerkSteps(joint, accelDegPerSec2),
+                                            !ignoreLimits);
+    return true;
+}
+
+bool JointManager::jogTo(size_t joint, float targetDeg, float speedDegPerSec, float accelDegPerSec2, uint32_t id)
+{
+    if (joint >= CONFIG_JOINT_COUNT || SafetyManager::instance().isEStopped())
+        return false;
+    if (!(fabsf(speedDegPerSec) > 0.0f) || !(fabsf(accelDegPerSec2) > 0.0f))
+        return false;
+    _reloadCache(joint);
+    const auto &c = _cache[joint];
+
+    float target = fminf(fmaxf(targetDeg, c.userMinDeg), c.userMaxDeg);
+    StepperManager::instance().jogTo(joint,
+                                     llroundf(target * c.stepsPerPhysDeg),
+                                     fabsf(speedDegPerSec) * c.stepsPerPhysDeg,
+                                     fabsf(accelDegPerSec2) * c.stepsPerPhysDeg,
+                                     _jogJerkSteps(joint, accelDegPerSec2),
+                                     id);
+    return true;
 }
 
 void JointManager::stopJog(size_t joint)
@@ -96,18 +257,18 @@ void JointManager::resetPosition(size_t j, float newDeg)
     if (j >= CONFIG_JOINT_COUNT)
         return;
     _reloadCache(j);
-    long steps = lroundf(newDeg * _cache[j].stepsPerPhysDeg);
+    int64_t steps = llroundf(newDeg * _cache[j].stepsPerPhysDeg);
     StepperManager::instance().resetPosition(j, steps);
 }
 
 float JointManager::getPosition(size_t joint)
 {
-    long steps = StepperManager::instance().getPosition(joint);
+    int64_t steps = StepperManager::instance().getPosition(joint);
     return float(steps) / _cache[joint].stepsPerPhysDeg;
 }
 float JointManager::getTarget(size_t joint)
 {
-    long tgt = StepperManager::instance().getTargetSteps(joint);
+    int64_t tgt = StepperManager::instance().getTargetSteps(joint);
     return float(tgt) / _cache[joint].stepsPerPhysDeg;
 }
 float JointManager::getSpeed(size_t joint)
@@ -121,6 +282,50 @@ float JointManager::getAccel(size_t joint)
     return aSteps / _cache[joint].stepsPerPhysDeg;
 }
 
+// All joints from one StepperManager snapshot (same tick); returns the tick
+uint32_t JointManager::getJointStates(JointState out[CONFIG_JOINT_COUNT])
+{
+    StepperManager::Snapshot snap;
+    StepperManager::instance().snapshot(snap);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        _reloadCache(j);
+        float k = _cache[j].stepsPerPhysDeg;
+        const auto &js = snap.joint[j];
+        out[j].position = float(js.position) / k;
+        out[j].target = float(js.target) / k;
+        out[j].speed = js.velocity / k;
+        out[j].accel = js.accel / k;
+    }
+    float pose[CONFIG_JOINT_COUNT], limit[CONFIG_JOINT_COUNT];
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        pose[j] = out[j].position;
+    _accelLimits(pose, pose, limit);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        out[j].accelLimit = limit[j];
+    return snap.tick;
+}
+
+float JointManager::getMaxStepSpeed(size_t joint)
+{
+    _reloadCache(joint);
+    return StepperManager::instance().maxStepRate(joint) / _cache[joint].stepsPerPhysDeg;
+}
+
+void JointManager::reloadConfig(size_t j)
+{
+    if (j >= CONFIG_JOINT_COUNT)
+        return;
+    _cache[j].dirty = true;
+    _reloadCache(j);
+}
+
+void JointManager::reloadConfig()
+{
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        reloadConfig(j);
+}
+
 void JointManager::setSoftLimits(size_t j, float mn, float mx)
 {
     char key[32];
@@ -168,6 +373,124 @@ float JointManager::getMaxAccel(size_t j)
     snprintf(key, sizeof(key), "joint%u.maxAccel", unsigned(j + 1));
     return ConfigManager::instance().getParameter(key, JOINT_CONFIG[j].maxAcceleration);
 }
+float JointManager::getAccelLimit(size_t j)
+{
+    float pose[CONFIG_JOINT_COUNT], limit[CONFIG_JOINT_COUNT];
+    for (size_t i = 0; i < CONFIG_JOINT_COUNT; ++i)
+    {
+        _reloadCache(i);
+        pose[i] = getPosition(i);
+    }
+    _accelLimits(pose, pose, limit);
+    return limit[j];
+}
+
+void JointManager::setMaxJerk(size_t j, float jerk)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "joint%u.maxJerk", unsigned(j + 1));
+    ConfigManager::instance().setParameter(key, jerk);
+    _cache[j].dirty = true;
+}
+float JointManager::getMaxJerk(size_t j)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "joint%u.maxJerk", unsigned(j + 1));
+    return ConfigManager::instance().getParameter(key, JOINT_CONFIG[j].maxJerk);
+}
+
+void JointManager::setMaxJogLag(size_t j, float seconds)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "joint%u.maxJogLag", unsigned(j + 1));
+    ConfigManager::instance().setParameter(key, seconds);
+    _cache[j].dirty = true;
+}
+float JointManager::getMaxJogLag(size_t j)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "joint%u.maxJogLag", unsigned(j + 1));
+    return ConfigManager::instance().getParameter(key, JOINT_CONFIG[j].maxJogLag);
+}
+
+void JointManager::setStepTiming(size_t j, float pulseUs, float dirSetupUs)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "joint%u.stepPulseUs", unsigned(j + 1));
+    ConfigManager::instance().setParameter(key, pulseUs);
+    snprintf(key, sizeof(key), "joint%u.dirSetupUs", unsigned(j + 1));
+    ConfigManager::instance().setParameter(key, dirSetupUs);
+    _cache[j].dirty = true;
+    _reloadCache(j);
+}
+void JointManager::getStepTiming(size_t j, float &pulseUs, float &dirSetupUs)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "joint%u.stepPulseUs", unsigned(j + 1));
+    pulseUs = ConfigManager::instance().getParameter(key, JOINT_CONFIG[j].stepPulseUs);
+    snprintf(key, sizeof(key), "joint%u.dirSetupUs", unsigned(j + 1));
+    dirSetupUs = ConfigManager::instance().getParameter(key, JOINT_CONFIG[j].dirSetupUs);
+}
+
+void JointManager::setBacklash(size_t j, float deg, float speedDegPerSec)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "joint%u.backlash", unsigned(j + 1));
+    ConfigManager::instance().setParameter(key, deg);
+    snprintf(key, sizeof(key), "joint%u.backlashSpeed", unsigned(j + 1));
+    ConfigManager::instance().setParameter(key, speedDegPerSec);
+    _cache[j].dirty = true;
+    _reloadCache(j);
+}
+void JointManager::getBacklash(size_t j, float &deg, float &speedDegPerSec)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "joint%u.backlash", unsigned(j + 1));
+    deg = ConfigManager::instance().getParameter(key, JOINT_CONFIG[j].backlash);
+    snprintf(key, sizeof(key), "joint%u.backlashSpeed", unsigned(j + 1));
+    speedDegPerSec = ConfigManager::instance().getParameter(key, JOINT_CONFIG[j].backlashSpeed);
+}
+
+bool JointManager::setShaper(size_t j, ShaperType type, float hz, float damping)
+{
+    InputShaper shaper;
+    if (!shaper.design(type, hz, damping) || !StepperManager::instance().setShaper(j, shaper))
+        return false;
+    char key[32];
+    snprintf(key, sizeof(key), "joint%u.shaper", unsigned(j + 1));
+    ConfigManager::instance().setParameter(key, float(type));
+    snprintf(key, sizeof(key), "joint%u.shaperHz", unsigned(j + 1));
+    ConfigManager::instance().setParameter(key, hz);
+    snprintf(key, sizeof(key), "joint%u.shaperDamping", unsigned(j + 1));
+    ConfigManager::instance().setParameter(key, damping);
+    _cache[j].dirty = true;
+    _reloadCache(j);
+    return true;
+}
+void JointManager::getShaper(size_t j, ShaperType &type, float &hz, float &damping)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "joint%u.shaper", unsigned(j + 1));
+    type = ShaperType(uint8_t(ConfigManager::instance().getParameter(key, JOINT_CONFIG[j].shaper)));
+    snprintf(key, sizeof(key), "joint%u.shaperHz", unsigned(j + 1));
+    hz = ConfigManager::instance().getParameter(key, JOINT_CONFIG[j].shaperHz);
+    snprintf(key, sizeof(key), "joint%u.shaperDamping", unsigned(j + 1));
+    damping = ConfigManager::instance().getParameter(key, JOINT_CONFIG[j].shaperDamping);
+}
+
+// Jog slew jerk in steps/s³: the joint's jerk limit, raised where needed so
+// building up the acceleration (a / 2j behind a linear ramp) stays within
+// maxJogLag of the commanded velocity.
+float JointManager::_jogJerkSteps(size_t joint, float accelDegPerSec2) const
+{
+    const auto &c = _cache[joint];
+    float jerk = c.cfgMaxJerk;
+    if (jerk <= 0.0f)
+        return 0.0f;
+    if (c.cfgMaxJogLag > 0.0f)
+        jerk = fmaxf(jerk, fabsf(accelDegPerSec2) / (2.0f * c.cfgMaxJogLag));
+    return jerk * c.stepsPerPhysDeg;
+}
 
 void JointManager::_reloadCache(size_t joint)
 {
@@ -189,16 +512,61 @@ void JointManager::_reloadCache(size_t joint)
     snprintf(key, sizeof(key), "joint%u.maxAccel", unsigned(joint + 1));
     _cache[joint].cfgMaxAccel = ConfigManager::instance().getParameter(key, C.maxAcceleration);
 
+    snprintf(key, sizeof(key), "joint%u.maxJerk", unsigned(joint + 1));
+    _cache[joint].cfgMaxJerk = ConfigManager::instance().getParameter(key, C.maxJerk);
+
+    snprintf(key, sizeof(key), "joint%u.maxJogLag", unsigned(joint + 1));
+    _cache[joint].cfgMaxJogLag = ConfigManager::instance().getParameter(key, C.maxJogLag);
+
     snprintf(key, sizeof(key), "joint%u.jointMin", unsigned(joint + 1));
     _cache[joint].cfgMin = ConfigManager::instance().getParameter(key, C.jointMin);
 
     snprintf(key, sizeof(key), "joint%u.jointMax", unsigned(joint + 1));
     _cache[joint].cfgMax = ConfigManager::instance().getParameter(key, C.jointMax);
 
+    float pulseUs, dirSetupUs;
+    getStepTiming(joint, pulseUs, dirSetupUs);
+    StepperManager::instance().setStepTiming(joint, pulseUs, dirSetupUs);
+
     _cache[joint].stepsPerPhysDeg = (C.stepsPerRev * C.gearboxRatio / 360.0f) / _cache[joint].cfgFactor;
     _cache[joint].userMinDeg = _cache[joint].cfgMin - _cache[joint].cfgHomeOffset;
     _cache[joint].userMaxDeg = _cache[joint].cfgMax - _cache[joint].cfgHomeOffset;
+
+    float k = _cache[joint].stepsPerPhysDeg;
+    StepperManager::instance().setSoftLimits(joint,
+                                             llroundf(_cache[joint].userMinDeg * k),
+                                             llroundf(_cache[joint].userMaxDeg * k),
+                                             _cache[joint].cfgMaxAccel * k);
+
+    float backlash, backlashSpeed;
+    getBacklash(joint, backlash, backlashSpeed);
+    StepperManager::instance().setBacklash(joint, lroundf(fmaxf(backlash, 0.0f) * _cache[joint].stepsPerPhysDeg),
+                                           backlashSpeed * _cache[joint].stepsPerPhysDeg);
+
+    // a stored shaper that no longer designs (or fits) leaves the last one
+    ShaperType shaperType;
+    float shaperHz, shaperDamping;
+    getShaper(joint, shaperType, shaperHz, shaperDamping);
+    InputShaper shaper;
+    if (shaper.design(shaperType, shaperHz, shaperDamping))
+        StepperManager::instance().setShaper(joint, shaper);
     _cache[joint].dirty = false;
+    _sliceLimitStale = true;
+}
+
+// Each joint's maxAcceleration, scaled for anywhere in the pose box
+// loDeg..hiDeg; caches must be loaded
+void JointManager::_accelLimits(const float loDeg[CONFIG_JOINT_COUNT],
+                                const float hiDeg[CONFIG_JOINT_COUNT],
+                                float out[CONFIG_JOINT_COUNT])
+{
+    float scale[CONFIG_JOINT_COUNT];
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        out[j] = _cache[j].cfgMaxAccel;
+    float maxScale = ConfigManager::instance().getParameter("accel.scheduleMax", ACCEL_SCHEDULE_MAX_DEFAULT);
+    ArmModel::accelScale(loDeg, hiDeg, out, maxScale, scale);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        out[j] *= scale[j];
 }
 
 float JointManager::_stepsPerDeg(size_t joint) const
@@ -211,23 +579,85 @@ bool JointManager::isMoving(size_t) { return !StepperManager::instance().isIdle(
 bool JointManager::isAnyMoving() { return !StepperManager::instance().isIdle(); }
 bool JointManager::allJointsNearTarget(long) { return StepperManager::instance().isIdle(); }
 
-void JointManager::feedVelocitySlice(const float speedsDegPerSec[CONFIG_JOINT_COUNT],
-                                     const float accelsDegPerSec2[CONFIG_JOINT_COUNT])
+float JointManager::feedVelocitySlice(const float speedsDegPerSec[CONFIG_JOINT_COUNT],
+                                      const float accelsDegPerSec2[CONFIG_JOINT_COUNT],
+                                      const float pathAccelsDegPerSec2[CONFIG_JOINT_COUNT])
 {
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        _reloadCache(j);
+    uint32_t ms = millis();
+    if (_sliceLimitStale || ms != _sliceLimitMs)
+    {
+        float pose[CONFIG_JOINT_COUNT];
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            pose[j] = getPosition(j);
+        _accelLimits(pose, pose, _sliceAccelLimit);
+        _sliceLimitMs = ms;
+        _sliceLimitStale = false;
+    }
+    const float *accelLimit = _sliceAccelLimit;
+
+    // one time scale for every joint: the slew the host asks for and the
+    // accel its path implies are both held to the limit through k², never
+    // joint by joint
+    float vMax[CONFIG_JOINT_COUNT], aWant[CONFIG_JOINT_COUNT];
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        vMax[j] = fminf(_cache[j].cfgMaxSpeed, getMaxStepSpeed(j));
+        aWant[j] = fabsf(accelsDegPerSec2[j]);
+        if (pathAccelsDegPerSec2)
+            aWant[j] = fmaxf(aWant[j], fabsf(pathAccelsDegPerSec2[j]));
+    }
+    float k = sliceTimeScale(speedsDegPerSec, aWant, vMax, accelLimit, CONFIG_JOINT_COUNT);
+
     float vSteps[CONFIG_JOINT_COUNT];
     float aSteps[CONFIG_JOINT_COUNT];
+    float jSteps[CONFIG_JOINT_COUNT];
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        float a = fabsf(accelsDegPerSec2[j]) * k * k;
+        vSteps[j] = speedsDegPerSec[j] * k * _cache[j].stepsPerPhysDeg; // signed
+        aSteps[j] = a * _cache[j].stepsPerPhysDeg;
+        jSteps[j] = _jogJerkSteps(j, a);
+    }
+    StepperManager::instance().setJogTargetsAll(vSteps, aSteps, jSteps);
+    return k;
+}
+
+bool JointManager::setOverride(float scale)
+{
+    return StepperManager::instance().setFeedOverride(scale);
+}
+
+float JointManager::getOverride()
+{
+    return StepperManager::instance().feedOverride();
+}
+
+float JointManager::slewOverride(float scale,
+                                 const float speedsDegPerSec[CONFIG_JOINT_COUNT],
+                                 const float accelsDegPerSec2[CONFIG_JOINT_COUNT],
+                                 float dtSec)
+{
+    float want = getOverride();
+    float ds = want - scale;
     for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
     {
+        float v = fabsf(speedsDegPerSec[j]);
+        if (!(v > 0.0f))
+            continue;
         _reloadCache(j);
-        vSteps[j] = speedsDegPerSec[j] * _cache[j].stepsPerPhysDeg; // signed
-        aSteps[j] = fabsf(accelsDegPerSec2[j]) * _cache[j].stepsPerPhysDeg;
+        float room = _cache[j].cfgMaxAccel - scale * scale * fabsf(accelsDegPerSec2[j]);
+        float most = fmaxf(room, 0.0f) * dtSec / v;
+        ds = fminf(fmaxf(ds, -most), most);
     }
-    StepperManager::instance().setJogTargetsAll(vSteps, aSteps);
+    return (ds == want - scale) ? want : scale + ds;
 }
 
 void JointManager::setAllJogZero(float accelDegPerSec2)
 {
     float aSteps = fabsf(accelDegPerSec2) * _cache[0].stepsPerPhysDeg; // use J0 factor—close enough
-    StepperManager::instance().setAllJogTargetsZero(aSteps);
+    float jSteps = _jogJerkSteps(0, accelDegPerSec2);
+    StepperManager::instance().setAllJogTargetsZero(aSteps, jSteps);
 }
 
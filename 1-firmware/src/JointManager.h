@@ -7,6 +7,7 @@
 #include "ConfigManager.h"
 #include "SafetyManager.h"
 #include "StepperManager.h"
+#include "PathPlanner.h"
 
 struct JointCache
 {
@@ -16,12 +17,23 @@ struct JointCache
   float cfgFactor;
   float cfgMaxSpeed;
   float cfgMaxAccel;
+  float cfgMaxJerk;
+  float cfgMaxJogLag;
   float stepsPerPhysDeg;
   bool dirty;
   float userMinDeg;
   float userMaxDeg;
 };
 
+struct JointState
+{
+  float position; // deg
+  float target;   // deg
+  float speed;    // deg/s
+  float accel;    // deg/s²
+  float accelLimit; // deg/s², maxAcceleration scaled for the pose
+};
+
 class JointManager
 {
 public:
@@ -35,16 +47,53 @@ public:
             float aMaxDegPerSec2,
             bool ignoreLimits = false);
 
+  // Queue behind the joint's running/queued moves; it starts as soon as
+  // they are done (blending if it carries on the same way). A non-zero id
+  // is reported through takeFinishedMove once it completes.
+  bool queueMove(size_t joint,
+                 float targetDeg,
+                 float vMaxDegPerSec,
+                 float aMaxDegPerSec2,
+                 uint32_t id);
+  bool takeFinishedMove(size_t &joint, uint32_t &id);
+
   bool moveMultiple(const size_t *joints,
                     const float *targets,
                     const float *speeds,
                     const float *accels,
                     size_t count,
-                    bool ignoreLimits = false);
-
+                    bool ignoreLimits = false,
+                    bool coordinated = false,
+                    float durationSec = 0);
+
+  // Blended waypoint: appended to the look-ahead window and passed through
+  // without stopping where the corner and the limits allow (PathPlanner).
+  // Joints not listed hold the previous waypoint's position. A non-zero id
+  // is reported through takeFinishedMove (joint FINISHED_PATH) once the
+  // arm gets there. Tolerance and window: path.deviation, path.window.
+  bool queuePath(const size_t *joints,
+                 const float *targets,
+                 const float *speeds,
+                 const float *accels,
+                 size_t count,
+                 uint32_t id);
+  // Starts waiting waypoints; call every loop
+  void servicePath();
+
+  // Jogs (and velocity slices) brake to a stop in time to halt at the
+  // soft limits; ignoreLimits runs past them (homing)
   bool jog(size_t joint,
            float targetDegPerSec,
-           float accelDegPerSec2);
+           float accelDegPerSec2,
+           bool ignoreLimits = false);
+  // Jog toward targetDeg (held inside the soft limits) and brake onto it
+  // exactly; the joint is then idle. A non-zero id is reported through
+  // takeFinishedMove on arrival.
+  bool jogTo(size_t joint,
+             float targetDeg,
+             float speedDegPerSec,
+             float accelDegPerSec2,
+             uint32_t id);
   void stopJog(size_t joint);
   void stopAll();
 
@@ -57,6 +106,15 @@ public:
   float getTarget(size_t joint);
   float getSpeed(size_t joint);
   float getAccel(size_t joint);
+  uint32_t getJointStates(JointState out[CONFIG_JOINT_COUNT]);
+  // Fastest joint speed the step output can emit (deg/s)
+  float getMaxStepSpeed(size_t joint);
+
+  // Config written straight to ConfigManager (setParam, home offset,
+  // position factor): reload the joint's cache, or every joint's, and
+  // apply it to the step generator at once
+  void reloadConfig(size_t joint);
+  void reloadConfig();
 
   void setSoftLimits(size_t joint, float minDeg, float maxDeg);
   void getSoftLimits(size_t joint, float &minDeg, float &maxDeg);
@@ -65,10 +123,49 @@ public:
   float getMaxSpeed(size_t joint);
   void setMaxAccel(size_t joint, float maxDegPerSec2);
   float getMaxAccel(size_t joint);
-
-  // NEW: feed one velocity slice (deg/s, deg/s²) for all joints
-  void feedVelocitySlice(const float speedsDegPerSec[CONFIG_JOINT_COUNT],
-                         const float accelsDegPerSec2[CONFIG_JOINT_COUNT]);
+  // maxAcceleration scaled for the current pose (ArmModel, capped by
+  // accel.scheduleMax); what blended paths are held to
+  float getAccelLimit(size_t joint);
+  void setMaxJerk(size_t joint, float maxDegPerSec3);
+  float getMaxJerk(size_t joint);
+  void setMaxJogLag(size_t joint, float seconds);
+  float getMaxJogLag(size_t joint);
+  // Driver step/dir timing (µs), applied to the step generator at once
+  void setStepTiming(size_t joint, float pulseUs, float dirSetupUs);
+  void getStepTiming(size_t joint, float &pulseUs, float &dirSetupUs);
+  // Drive-train play (deg) taken up after every reversal at speed (deg/s),
+  // applied to the step generator at once
+  void setBacklash(size_t joint, float deg, float speedDegPerSec);
+  void getBacklash(size_t joint, float &deg, float &speedDegPerSec);
+  // Input shaper against a vibration mode (Hz, damping ratio), applied to
+  // the step generator at once; false if the shaper is unusable or the
+  // joint is still moving
+  bool setShaper(size_t joint, ShaperType type, float hz, float damping);
+  void getShaper(size_t joint, ShaperType &type, float &hz, float &damping);
+
+  // NEW: feed one velocity slice (deg/s) for all joints, each slewing to
+  // its speed at accelsDegPerSec2. If any joint would exceed its maxSpeed
+  // or step rate, or its pose-scaled maxAccel at that slew or at the accel
+  // the path itself implies (pathAccelsDegPerSec2, optional), all of them
+  // are slowed by one time scale k (speeds by k, accels by k²) so the
+  // slice keeps its direction in joint space. Returns k (0..1].
+  float feedVelocitySlice(const float speedsDegPerSec[CONFIG_JOINT_COUNT],
+                          const float accelsDegPerSec2[CONFIG_JOINT_COUNT],
+                          const float pathAccelsDegPerSec2[CONFIG_JOINT_COUNT] = nullptr);
+
+  // Feed override (0 < scale <= StepperManager::FEED_OVERRIDE_MAX): moves,
+  // coordinated moves and blended paths run `scale` times as fast along
+  // the same path, the change slewed within each joint's maxAccel. Jogs
+  // and velocity slices are not scaled; batches follow it by slewOverride.
+  bool setOverride(float scale);
+  float getOverride();
+  // A batch running at `scale` moved toward getOverride() for one slice of
+  // dtSec, as far as every joint's maxAccel has room for: the change adds
+  // its rate times the joint's speed to the slice's own accel (at scale²).
+  float slewOverride(float scale,
+                     const float speedsDegPerSec[CONFIG_JOINT_COUNT],
+                     const float accelsDegPerSec2[CONFIG_JOINT_COUNT],
+                     float dtSec);
 
   // NEW: command all joints to zero speed smoothly
   void setAllJogZero(float accelDegPerSec2);
@@ -76,9 +173,28 @@ public:
 private:
   JointManager();
   void _reloadCache(size_t joint);
+  bool _stageMove(size_t joint, float targetDeg, float vMaxDegPerSec, float aMaxDegPerSec2, bool ignoreLimits);
+  float _jogJerkSteps(size_t joint, float accelDegPerSec2) const;
+  bool _moveCoordinated(const size_t *joints,
+                        const float *targets,
+                        const float *speeds,
+                        const float *accels,
+                        size_t count,
+                        bool ignoreLimits,
+                        float durationSec);
   float _stepsPerDeg(size_t joint) const;
+  void _accelLimits(const float loDeg[CONFIG_JOINT_COUNT],
+                    const float hiDeg[CONFIG_JOINT_COUNT],
+                    float out[CONFIG_JOINT_COUNT]);
 
   JointCache _cache[CONFIG_JOINT_COUNT];
+  // Pose-scaled accel limits velocity slices are held to, refreshed once
+  // per step planner period (1 ms) and after a cache reload
+  float _sliceAccelLimit[CONFIG_JOINT_COUNT];
+  uint32_t _sliceLimitMs = 0;
+  bool _sliceLimitStale = true;
+  PathPlanner _path;
+  size_t _pathWindow = PATH_WINDOW_DEFAULT;
 };
 
 #endif // JOINT_MANAGER_H
@@ -0,0 +1,689 @@
+#include "MotionProfile.h"
+#include <cmath>
+
+uint64_t toQ32(float value)
+{
+    if (!(value > 0.0f))
+        return 0;
+    return uint64_t(double(value) * double(Q32_ONE) + 0.5);
+}
+
+float fromQ32(uint64_t q)
+{
+    return float(double(q) / double(Q32_ONE));
+}
+
+uint64_t toQ48(float value)
+{
+    if (!(value > 0.0f))
+        return 0;
+    return uint64_t(ldexp(double(value), Q32_SHIFT + ACCEL_SHIFT) + 0.5);
+}
+
+float fromQ48(uint64_t q)
+{
+    return float(ldexp(double(q), -int(Q32_SHIFT + ACCEL_SHIFT)));
+}
+
+// Galloping + binary search for the first tick in (lo, hi] whose position
+// reaches sQ. Requires positionAt(lo) < sQ <= positionAt(hi). Evaluating the
+// same closed form as the polled ISR keeps both schedulers tick-identical.
+template <typename Profile>
+static uint32_t searchTick(const Profile &p, uint64_t sQ, uint32_t lo, uint32_t hi)
+{
+    uint32_t span = 1;
+    while (hi - lo > span)
+    {
+        uint32_t probe = lo + span;
+        if (p.positionAt(probe) >= sQ)
+        {
+            hi = probe;
+            break;
+        }
+        lo = probe;
+        span <<= 1;
+    }
+    while (hi - lo > 1)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (p.positionAt(mid) >= sQ)
+            hi = mid;
+        else
+            lo = mid;
+    }
+    return hi;
+}
+
+bool TrapezoidProfile::plan(uint32_t totalSteps, float vStepsPerTick, float aStepsPerTick2)
+{
+    uint64_t vMaxQ = toQ32(vStepsPerTick);
+    aQ = toQ48(aStepsPerTick2);
+    if (totalSteps == 0 || vMaxQ == 0 || aQ == 0)
+    {
+        nAccel = nCruise = nTotal = 0;
+        sAccelQ = sEndQ = 0;
+        return false;
+    }
+    const uint64_t vMaxX = vMaxQ << ACCEL_SHIFT;
+    if (aQ > vMaxX)
+        aQ = vMaxX; // full speed reached within one tick
+
+    const uint64_t targetQ = uint64_t(totalSteps) << Q32_SHIFT;
+
+    // Largest ramp that still fits a triangle: 2 * rampAt(n) <= targetQ
+    double ratio = ldexp(double(targetQ) / double(aQ), ACCEL_SHIFT);
+    uint64_t nTri = uint64_t((sqrt(4.0 * ratio + 1.0) - 1.0) * 0.5);
+    while (nTri > 0 && 2 * rampAt(uint32_t(nTri)) > targetQ)
+        --nTri;
+    while (2 * rampAt(uint32_t(nTri + 1)) <= targetQ)
+        ++nTri;
+
+    uint64_t nA = vMaxX / aQ;
+    if (nA > nTri)
+        nA = nTri;
+    if (nA == 0)
+        nA = 1;
+
+    nAccel = uint32_t(nA);
+    vQ = accelTimes(aQ, nA);
+    if (vQ == 0)
+        vQ = 1;
+    sAccelQ = rampAt(nAccel);
+
+    // Cruise long enough to cover the remainder; rounding up means the last
+    // step always lands on or before nTotal.
+    uint64_t ramps = 2 * sAccelQ; // accel + symmetric decel distance
+    uint64_t rem = (targetQ > ramps) ? targetQ - ramps : 0;
+    nCruise = uint32_t((rem + vQ - 1) / vQ);
+    nTotal = 2 * nAccel + nCruise;
+    sEndQ = ramps + vQ * nCruise;
+    return true;
+}
+
+uint32_t TrapezoidProfile::tickReaching(uint64_t sQ, uint32_t from) const
+{
+    if (sQ > sEndQ || from >= nTotal)
+        return TICK_NEVER;
+    if (positionAt(from) >= sQ)
+        return from + 1;
+    return searchTick(*this, sQ, from, nTotal);
+}
+
+bool SCurveProfile::plan(uint32_t totalSteps, float vStepsPerTick, float aStepsPerTick2, float jStepsPerTick3)
+{
+    const double D = totalSteps;
+    double v = vStepsPerTick, a = aStepsPerTick2, j = jStepsPerTick3;
+    nJerk = nHold = nAccel = nCruise = nTotal = 0;
+    sAccelQ = sCruiseQ = sEndQ = 0;
+    if (totalSteps == 0 || !(v > 0) || !(a > 0) || !(j > 0))
+        return false;
+
+    // Ramp distance (accel + decel) at peak speed v: without a hold phase
+    // when v <= a²/j (aPeak never reached), with one otherwise.
+    const double vNoHold = a * a / j;
+    double ramps = (v <= vNoHold) ? 2.0 * v * sqrt(v / j) : v * (a / j + v / a);
+    if (ramps > D)
+    {
+        // too short to cruise: largest peak speed whose ramps fit exactly
+        v = cbrt(D * D * j / 4.0);
+        if (v > vNoHold)
+            v = 0.5 * a * (sqrt(a * a / (j * j) + 4.0 * D / a) - a / j);
+    }
+    double tJerk = (v <= vNoHold) ? sqrt(v / j) : a / j;
+    double tHold = (v <= vNoHold) ? 0.0 : v / a - a / j;
+    if (2.0 * ceil(tJerk) + ceil(tHold) > MAX_JERK_RAMP_TICKS)
+        return false;
+
+    nJerk = uint32_t(ceil(tJerk));
+    if (nJerk == 0)
+        nJerk = 1;
+    nHold = uint32_t(ceil(tHold));
+    nAccel = 2 * nJerk + nHold;
+    double cruise = (D - v * nAccel) / v;
+    nCruise = cruise > 0 ? uint32_t(ceil(cruise)) : 0;
+
+    // The accel phase in jerk units: tick n of the jerk-up segment
+    // accelerates by n, the hold by nJerk, the jerk-down by nJerk - n
+    const uint64_t nJ = nJerk, nH = nHold;
+    _p1 = tetrahedron(nJ);
+    _w1 = triangle(nJ);
+    _p2 = _p1 + _w1 * nH + nJ * triangle(nH);
+    _w2 = _w1 + nJ * nH;
+    _w = nJ * (nJ + nH);
+    const uint64_t pA = rampPoly(nAccel);
+
+    // Rounded-up segments only lower the peaks; fit the jerk to land on D,
+    // held to every limit, then keep 62 significant bits of it (rounded
+    // down) however small it is
+    const uint64_t targetQ = uint64_t(totalSteps) << Q32_SHIFT;
+    double fit = double(targetQ) / (2.0 * double(pA) + double(_w) * nCruise);
+    fit = fmin(fit, ldexp(j, Q32_SHIFT));
+    fit = fmin(fit, ldexp(a, Q32_SHIFT) / double(nJ));
+    fit = fmin(fit, ldexp(double(vStepsPerTick), Q32_SHIFT) / double(_w));
+    int e;
+    frexp(fit, &e); // fit in [2^(e-1), 2^e)
+    if (!(fit > 0) || e > 62 || e < 62 - 120)
+    {
+        nJerk = nHold = nAccel = nCruise = 0;
+        return false;
+    }
+    jerkShift = uint32_t(62 - e);
+    jerkQ = uint64_t(ldexp(fit, int(jerkShift)));
+    _vPeakW = Wide::mul(int64_t(jerkQ), _w);
+    sAccelQ = rampAt(nAccel);
+
+    // Cruise on until the target is covered (a tick or two once the jerk
+    // has been rounded down; more if a limit held it back)
+    uint64_t ramp2 = 2 * sAccelQ;
+    nCruise = 0;
+    if (ramp2 < targetQ)
+    {
+        double speed = ldexp(double(jerkQ) * double(_w), -int(jerkShift));
+        nCruise = uint32_t(fmax(ceil(double(targetQ - ramp2) / speed) - 1.0, 0.0));
+        while (ramp2 + _vPeakW.mulShr(nCruise, jerkShift) < targetQ)
+            ++nCruise;
+    }
+    nTotal = 2 * nAccel + nCruise;
+    sCruiseQ = sAccelQ + _vPeakW.mulShr(nCruise, jerkShift);
+    sEndQ = sCruiseQ + sAccelQ;
+
+    double jr = ldexp(double(jerkQ), -int(Q32_SHIFT + jerkShift));
+    aPeak = jr * double(nJ);
+    vPeak = jr * double(_w);
+    return true;
+}
+
+uint32_t SCurveProfile::tickReaching(uint64_t sQ, uint32_t from) const
+{
+    if (sQ > sEndQ || from >= nTotal)
+        return TICK_NEVER;
+    if (positionAt(from) >= sQ)
+        return from + 1;
+    return searchTick(*this, sQ, from, nTotal);
+}
+
+// Accel-phase distance after n ticks, in jerk units
+uint64_t SCurveProfile::rampPoly(uint32_t n) const
+{
+    if (n <= nJerk)
+        return tetrahedron(n);
+    if (n <= nJerk + nHold)
+    {
+        uint64_t u = n - nJerk;
+        return _p1 + _w1 * u + uint64_t(nJerk) * triangle(u);
+    }
+    uint64_t w = n - nJerk - nHold;
+    return _p2 + _w2 * w + uint64_t(nJerk) * triangle(w) - tetrahedron(w);
+}
+
+// Accel-phase speed after n ticks (distance moved in tick n), jerk units
+uint64_t SCurveProfile::rampSpeed(uint32_t n) const
+{
+    if (n <= nJerk)
+        return triangle(n);
+    if (n <= nJerk + nHold)
+        return _w1 + uint64_t(nJerk) * (n - nJerk);
+    uint64_t w = n - nJerk - nHold;
+    return _w2 + uint64_t(nJerk) * w - triangle(w);
+}
+
+double SCurveProfile::velocityAt(uint32_t n) const
+{
+    if (n >= nTotal)
+        return 0;
+    uint64_t w;
+    if (n <= nAccel)
+        w = rampSpeed(n);
+    else if (n - nAccel <= nCruise)
+        w = _w;
+    else
+        w = rampSpeed(nTotal - n + 1);
+    return ldexp(double(jerkQ) * double(w), -int(Q32_SHIFT + jerkShift));
+}
+
+double SCurveProfile::accelAt(uint32_t n) const
+{
+    if (n >= nTotal || n == 0)
+        return 0;
+    double jr = ldexp(double(jerkQ), -int(Q32_SHIFT + jerkShift));
+    if (n <= nAccel)
+    {
+        if (n <= nJerk)
+            return jr * n;
+        if (n <= nJerk + nHold)
+            return aPeak;
+        return jr * double(nAccel - n);
+    }
+    if (n - nAccel <= nCruise)
+        return 0;
+    uint32_t m = nTotal - n + 1;
+    if (m <= nJerk)
+        return -jr * m;
+    if (m <= nJerk + nHold)
+        return -aPeak;
+    return -jr * double(nAccel - m);
+}
+
+bool MoveProfile::plan(uint32_t totalSteps, float vStepsPerTick, float aStepsPerTick2, float jStepsPerTick3)
+{
+    sCurve = (jStepsPerTick3 > 0);
+    return sCurve ? curve.plan(totalSteps, vStepsPerTick, aStepsPerTick2, jStepsPerTick3)
+                  : trap.plan(totalSteps, vStepsPerTick, aStepsPerTick2);
+}
+
+namespace
+{
+struct BlendedMove
+{
+    const MoveProfile &head;
+    const BlendTail &tail;
+    inline uint64_t positionAt(uint32_t n) const { return head.positionAt(n) + tail.positionAt(n); }
+};
+}
+
+uint32_t BlendTail::tickReaching(const MoveProfile &head, uint64_t sQ, uint32_t from) const
+{
+    BlendedMove m{head, *this};
+    uint32_t end = head.totalTicks();
+    if (endTick() > end)
+        end = endTick();
+    if (from >= end || m.positionAt(end) < sQ)
+        return TICK_NEVER;
+    if (m.positionAt(from) >= sQ)
+        return from + 1;
+    return searchTick(m, sQ, from, end);
+}
+
+bool LinkProfile::plan(uint32_t totalSteps, double fromV, double toV, double vMax, double aMax)
+{
+    const double D = totalSteps;
+    if (totalSteps == 0 || !(vMax > 0) || !(aMax > 0))
+    {
+        nAccel = nCruise = nDecel = nTotal = 0;
+        sEndQ = 0;
+        return false;
+    }
+    v0 = fromV > 0 ? fromV : 0;
+    v1 = toV > 0 ? toV : 0;
+
+    // peak: the cruise limit, or where the two ramps meet
+    double v = fmin(vMax, sqrt(aMax * D + 0.5 * (v0 * v0 + v1 * v1)));
+    v = fmax(v, fmax(v0, v1));
+    nAccel = uint32_t(ceil((v - v0) / aMax));
+    nDecel = uint32_t(ceil((v - v1) / aMax));
+    double ramps = 0.5 * (nAccel * (v0 + v) + nDecel * (v + v1));
+    nCruise = ramps < D ? uint32_t(ceil((D - ramps) / v)) : 0;
+
+    // refit the peak so the block ends exactly on D; rounding the phases up
+    // only ever lowers it
+    double left = D - 0.5 * (nAccel * v0 + nDecel * v1);
+    double span = 0.5 * (nAccel + nDecel) + nCruise;
+    if (!(left > 0) || !(span > 0))
+    {
+        // too short to ramp between its join speeds: cross it at their mean
+        nAccel = nDecel = 0;
+        nCruise = uint32_t(ceil(D / (0.5 * (v0 + v1))));
+        left = D;
+        span = nCruise;
+    }
+    vPeak = left / span;
+    aUp = nAccel ? (vPeak - v0) / nAccel : 0;
+    aDown = nDecel ? (vPeak - v1) / nDecel : 0;
+    nTotal = nAccel + nCruise + nDecel;
+    sAccel = 0.5 * nAccel * (v0 + vPeak);
+    sCruise = sAccel + vPeak * nCruise;
+    sEndQ = uint64_t(totalSteps) << Q32_SHIFT;
+    return true;
+}
+
+uint32_t LinkProfile::tickReaching(uint64_t sQ, uint32_t from) const
+{
+    if (from >= nTotal || sQ > sEndQ)
+        return TICK_NEVER;
+    if (positionAt(from) >= sQ)
+        return from + 1;
+    return searchTick(*this, sQ, from, nTotal);
+}
+
+double LinkProfile::velocityAt(uint32_t n) const
+{
+    if (n >= nTotal)
+        return 0;
+    if (n <= nAccel)
+        return v0 + aUp * n;
+    if (n - nAccel <= nCruise)
+        return vPeak;
+    return vPeak - aDown * (n - nAccel - nCruise);
+}
+
+double LinkProfile::accelAt(uint32_t n) const
+{
+    if (n >= nTotal)
+        return 0;
+    if (n < nAccel)
+        return aUp;
+    if (n - nAccel < nCruise)
+        return 0;
+    return -aDown;
+}
+
+float MoveProfile::velocityAt(uint32_t n) const
+{
+    return sCurve ? float(curve.velocityAt(n)) : fromQ32(trap.velocityAt(n));
+}
+
+float MoveProfile::accelAt(uint32_t n) const
+{
+    return sCurve ? float(curve.accelAt(n)) : trap.accelSignAt(n) * fromQ48(trap.aQ);
+}
+
+float MoveProfile::peakVelocity() const
+{
+    return sCurve ? float(curve.vPeak) : fromQ32(trap.vQ);
+}
+
+float MoveProfile::peakAccel() const
+{
+    return sCurve ? float(curve.aPeak) : fromQ48(trap.aQ);
+}
+
+void RampProfile::plan(uint64_t fromVQ, uint64_t toVQ, uint64_t accelQ)
+{
+    v0Q = fromVQ;
+    aQ = accelQ;
+    if (aQ == 0)
+        toVQ = fromVQ; // no slew authority: hold the current speed
+    vtQ = toVQ;
+    up = (vtQ >= v0Q);
+    uint64_t dv = up ? vtQ - v0Q : v0Q - vtQ;
+    nRamp = aQ ? uint32_t((dv << ACCEL_SHIFT) / aQ) : 0;
+    sRampQ = positionAt(nRamp);
+}
+
+uint32_t RampProfile::tickReaching(uint64_t sQ, uint32_t from) const
+{
+    if (sQ > sRampQ)
+    {
+        // beyond the slew: constant vtQ, solved directly
+        if (vtQ == 0)
+            return TICK_NEVER;
+        uint64_t k = nRamp + (sQ - sRampQ + vtQ - 1) / vtQ;
+        if (k <= from)
+            return from + 1;
+        return k >= TICK_NEVER ? TICK_NEVER : uint32_t(k);
+    }
+    if (positionAt(from) >= sQ)
+        return from + 1;
+    return searchTick(*this, sQ, from, nRamp);
+}
+
+void SCurveRamp::plan(int64_t vX, int64_t aX, double toV, double aMax, double jMax)
+{
+    const double unit = ldexp(1.0, Q32_SHIFT + JERK_SHIFT);
+    kEnd = 0;
+    sEndQ = 0;
+    if (!(aMax > 0) || !(jMax > 0))
+    {
+        vtQ = vX > 0 ? uint64_t(vX) >> JERK_SHIFT : 0;
+        for (auto &g : _seg)
+            g = {0, Wide(), vX, 0, 0};
+        return;
+    }
+    if (!(toV > 0))
+        toV = 0;
+    vtQ = uint64_t(ldexp(toV, Q32_SHIFT) + 0.5);
+    const double fromV = double(vX) / unit;
+
+    double a0 = double(aX) / unit;
+    if (a0 > aMax)
+        a0 = aMax;
+    if (a0 < -aMax)
+        a0 = -aMax;
+    // unwinding a deceleration must not dip below standstill
+    if (a0 < 0 && a0 * a0 > 2.0 * jMax * fromV)
+        a0 = -sqrt(2.0 * jMax * fromV);
+
+    // Speed reached by bringing a0 straight back to zero decides the sign
+    // of the peak; its size solves jerk-up + jerk-down covering toV - fromV
+    // (with a hold at aMax when the triangle would exceed it).
+    double vStop = fromV + a0 * fabs(a0) / (2.0 * jMax);
+    double sgn = (toV >= vStop) ? 1.0 : -1.0;
+    double dv = sgn * (toV - fromV);
+    double peak = sqrt((2.0 * jMax * dv + a0 * a0) * 0.5);
+    double hold = 0;
+    if (peak > aMax)
+    {
+        peak = aMax;
+        hold = (dv - (2.0 * aMax * aMax - a0 * a0) / (2.0 * jMax)) / aMax;
+        if (hold < 0)
+            hold = 0;
+    }
+    double dur[3] = {fabs(sgn * peak - a0) / jMax, hold, peak / jMax};
+    if (!(dur[0] + dur[1] + dur[2] > 0))
+    {
+        // already there
+        vtQ = uint64_t(vX) >> JERK_SHIFT;
+        for (auto &g : _seg)
+            g = {0, Wide(), vX, 0, 0};
+        return;
+    }
+
+    // Whole ticks, rounded up (at least one to leave and one to join the
+    // peak), then the peak accel refitted so the speed ends on toV: with
+    // jerk-up over n1 ticks, hold n2, jerk-down n3, the speed gains
+    // a0 * (n1 - 1) / 2 + aP * ((n1 + n3) / 2 + n2). The last jerk is
+    // fitted to the speed reached so far, rounded so the slew ends at or
+    // above toV: never below standstill when stopping.
+    uint32_t n[3];
+    for (int i = 0; i < 3; ++i)
+        n[i] = uint32_t(fmin(ceil(dur[i]), double(MAX_JERK_RAMP_TICKS)));
+    n[0] = n[0] ? n[0] : 1;
+    n[2] = n[2] ? n[2] : 1;
+    const int64_t a0X = int64_t(llround(a0 * unit));
+    double gain = (toV - fromV) * unit - double(a0X) * (n[0] - 1) * 0.5;
+    double aP = gain / ((n[0] + n[2]) * 0.5 + n[1]);
+    int64_t jrk[3] = {int64_t(llround((aP - double(a0X)) / n[0])), 0, 0};
+    const int64_t vtX = int64_t(vtQ << JERK_SHIFT);
+
+    uint32_t k = 0;
+    Wide sX;
+    int64_t v = vX, acc = a0X;
+    for (int i = 0; i < 3; ++i)
+    {
+        if (i == 2)
+        {
+            const int64_t t2 = int64_t(triangle(n[2]));
+            const int64_t coast = v + acc * int64_t(n[2]);
+            jrk[2] = int64_t(ceil(double(vtX - coast) / double(t2)));
+            while (coast + jrk[2] * t2 < vtX)
+                ++jrk[2];
+            while (coast + (jrk[2] - 1) * t2 >= vtX)
+                --jrk[2];
+        }
+        _seg[i] = {k, sX, v, acc, jrk[i]};
+        uint64_t u = n[i];
+        sX += Wide::mul(v, u);
+        sX += Wide::mul(acc, triangle(u));
+        sX += Wide::mul(jrk[i], tetrahedron(u));
+        v += acc * int64_t(u) + jrk[i] * int64_t(triangle(u));
+        acc += jrk[i] * int64_t(u);
+        k += n[i];
+    }
+    kEnd = k;
+    int64_t end = sX.toQ32();
+    sEndQ = end > 0 ? uint64_t(end) : 0;
+}
+
+void SCurveRamp::stateAt(uint32_t k, int64_t &vX, int64_t &aX) const
+{
+    if (k >= kEnd)
+    {
+        vX = int64_t(vtQ << JERK_SHIFT);
+        aX = 0;
+        return;
+    }
+    const Segment &g = segmentAt(k);
+    uint32_t u = k - g.k;
+    vX = g.v + g.a * int64_t(u) + g.j * int64_t(triangle(u));
+    aX = g.a + g.j * int64_t(u);
+}
+
+double SCurveRamp::velocityAt(uint32_t k) const
+{
+    int64_t v, a;
+    stateAt(k, v, a);
+    return ldexp(double(v), -int(Q32_SHIFT + JERK_SHIFT));
+}
+
+double SCurveRamp::accelAt(uint32_t k) const
+{
+    int64_t v, a;
+    stateAt(k, v, a);
+    return ldexp(double(a), -int(Q32_SHIFT + JERK_SHIFT));
+}
+
+uint32_t SCurveRamp::tickReaching(uint64_t sQ, uint32_t from) const
+{
+    if (positionAt(from) >= sQ)
+        return from + 1;
+    if (kEnd > from && positionAt(kEnd) >= sQ)
+        return searchTick(*this, sQ, from, kEnd);
+
+    // beyond the slew: constant vtQ, solved directly
+    if (vtQ == 0)
+        return TICK_NEVER;
+    uint64_t k = kEnd + (sQ - sEndQ + vtQ - 1) / vtQ;
+    if (k <= from)
+        return from + 1;
+    return k >= TICK_NEVER ? TICK_NEVER : uint32_t(k);
+}
+
+void JogProfile::reset()
+{
+    sCurve = false;
+    linear.plan(0, 0, 0);
+}
+
+void JogProfile::retarget(uint32_t k, double toV, double aMax, double jMax)
+{
+    if (jMax > 0)
+    {
+        // carried over exactly, as Q60
+        int64_t v, a;
+        if (sCurve)
+            curve.stateAt(k, v, a);
+        else
+        {
+            v = int64_t(linear.velocityAt(k) << JERK_SHIFT);
+            a = linear.ramping(k) ? int64_t(linear.aQ << (JERK_SHIFT - ACCEL_SHIFT)) : 0;
+            if (!linear.up)
+                a = -a;
+        }
+        curve.plan(v, a, toV, aMax, jMax);
+        sCurve = true;
+    }
+    else
+    {
+        // the linear ramp carries its own speed exactly in Q32
+        uint64_t vQ;
+        if (sCurve)
+        {
+            int64_t v, a;
+            curve.stateAt(k, v, a);
+            vQ = v > 0 ? uint64_t(v) >> JERK_SHIFT : 0;
+        }
+        else
+            vQ = linear.velocityAt(k);
+        linear.plan(vQ, toQ32(float(toV)), toQ48(float(aMax)));
+        sCurve = false;
+    }
+}
+
+uint32_t JogProfile::settleTick() const
+{
+    return sCurve ? curve.kEnd : linear.nRamp;
+}
+
+void JogProfile::rebase()
+{
+    if (sCurve)
+        curve.plan(int64_t(curve.vtQ << JERK_SHIFT), 0, 0, 0, 0);
+    else
+        linear.plan(linear.vtQ, linear.vtQ, linear.aQ);
+}
+
+double JogProfile::velocityAt(uint32_t k) const
+{
+    return sCurve ? curve.velocityAt(k) : double(fromQ32(linear.velocityAt(k)));
+}
+
+double JogProfile::accelAt(uint32_t k) const
+{
+    if (sCurve)
+        return curve.accelAt(k);
+    if (!linear.ramping(k))
+        return 0;
+    double a = fromQ48(linear.aQ);
+    return linear.up ? a : -a;
+}
+
+bool InputShaper::design(ShaperType type, float hz, float damping)
+{
+    count = 0;
+    if (type == ShaperType::None)
+        return true;
+    if (!(hz > 0.0f) || !(damping >= 0.0f && damping < 1.0f))
+        return false;
+    float df = sqrtf(1.0f - damping * damping);
+    float K = expf(-damping * float(M_PI) / df);
+    float half = 0.5f / (hz * df); // half a damped period
+    switch (type)
+    {
+    case ShaperType::ZV:
+        count = 2;
+        amp[0] = 1.0f;
+        amp[1] = K;
+        break;
+    case ShaperType::ZVD:
+        count = 3;
+        amp[0] = 1.0f;
+        amp[1] = 2.0f * K;
+        amp[2] = K * K;
+        break;
+    case ShaperType::EI:
+    {
+        const float v = 0.05f; // residual vibration tolerated at the design frequency
+        count = 3;
+        amp[0] = 0.25f * (1.0f + v);
+        amp[1] = 0.5f * (1.0f - v) * K;
+        amp[2] = 0.25f * (1.0f + v) * K * K;
+        break;
+    }
+    default:
+        return false;
+    }
+    float sum = 0;
+    for (uint8_t i = 0; i < count; ++i)
+    {
+        delay[i] = half * i;
+        sum += amp[i];
+    }
+    for (uint8_t i = 0; i < count; ++i)
+        amp[i] /= sum;
+    return true;
+}
+
+float sliceTimeScale(const float *speed, const float *accel,
+                     const float *speedLimit, const float *accelLimit, size_t n)
+{
+    float k = 1.0f;
+    for (size_t j = 0; j < n; ++j)
+    {
+        float v = fabsf(speed[j]), a = fabsf(accel[j]);
+        if (speedLimit[j] > 0.0f && v > speedLimit[j])
+            k = fminf(k, speedLimit[j] / v);
+        if (accelLimit[j] > 0.0f && a > accelLimit[j])
+            k = fminf(k, sqrtf(accelLimit[j] / a));
+    }
+    return k;
+}
@@ -0,0 +1,495 @@
+#ifndef MOTION_PROFILE_H
+#define MOTION_PROFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Fixed-point step-generator conventions:
+//   - time is an integer ISR tick index (no accumulated float seconds)
+//   - velocities are Q32 steps/tick, accelerations Q48 steps/tick² (a slow
+//     joint at a fast tick is ~1e-9 steps/tick², a few Q32 LSBs)
+//   - distances along a profile are Q32 steps; (pos >> 32) = whole steps due
+static constexpr uint32_t Q32_SHIFT = 32;
+static constexpr uint64_t Q32_ONE = 1ULL << Q32_SHIFT;
+static constexpr uint64_t Q32_FRAC_MASK = Q32_ONE - 1;
+static constexpr uint32_t ACCEL_SHIFT = 16; // Q48 accel -> Q32 speed/distance
+
+// Returned by the tickReaching() searches when the distance is never reached
+static constexpr uint32_t TICK_NEVER = 0xFFFFFFFFUL;
+
+uint64_t toQ32(float value);
+float fromQ32(uint64_t q);
+uint64_t toQ48(float value);
+float fromQ48(uint64_t q);
+
+// floor(aQ48 * n / 2^16): a Q48 accel times a tick count (or a sum of tick
+// counts) as Q32, exact without a 128-bit product while aQ48 * 2^16 fits
+inline uint64_t accelTimes(uint64_t aQ48, uint64_t n)
+{
+    return aQ48 * (n >> ACCEL_SHIFT) + ((aQ48 * (n & 0xFFFF)) >> ACCEL_SHIFT);
+}
+
+// The jerk-limited jog slew carries speed, accel and jerk as Q60 (Q32 <<
+// 28) so a slow joint's jerk keeps its precision; the move profile scales
+// its jerk per plan. Rate times tick-count products are summed exactly in
+// 128 bits and shifted back to Q32.
+static constexpr uint32_t JERK_SHIFT = 28;
+// Longest jerk-limited ramp: its tick polynomials stay within 64 bits
+static constexpr uint32_t MAX_JERK_RAMP_TICKS = 2000000;
+
+struct Wide
+{
+    uint64_t lo = 0;
+    uint64_t hi = 0; // two's complement
+
+    static inline Wide mul(int64_t a, uint64_t b)
+    {
+        uint64_t m = a < 0 ? 0 - uint64_t(a) : uint64_t(a);
+        uint64_t mL = uint32_t(m), mH = m >> 32, bL = uint32_t(b), bH = b >> 32;
+        uint64_t ll = mL * bL, lh = mL * bH, hl = mH * bL;
+        uint64_t mid = (ll >> 32) + uint32_t(lh) + uint32_t(hl);
+        Wide w;
+        w.lo = (mid << 32) | uint32_t(ll);
+        w.hi = mH * bH + (lh >> 32) + (hl >> 32) + (mid >> 32);
+        return a < 0 ? -w : w;
+    }
+    inline Wide operator-() const
+    {
+        Wide w;
+        w.lo = 0 - lo;
+        w.hi = ~hi + (lo == 0);
+        return w;
+    }
+    inline Wide &operator+=(const Wide &o)
+    {
+        uint64_t l = lo + o.lo;
+        hi += o.hi + (l < lo);
+        lo = l;
+        return *this;
+    }
+    // floor(x / 2^s), 0 < s < 128, assumed to fit
+    inline int64_t shr(uint32_t s) const
+    {
+        if (s >= 64)
+            return int64_t(hi) >> (s - 64);
+        return int64_t((lo >> s) | (hi << (64 - s)));
+    }
+    // A Q60 sum as Q32
+    inline int64_t toQ32() const { return shr(JERK_SHIFT); }
+    // floor(x * u / 2^s) for x >= 0, assumed to fit
+    inline uint64_t mulShr(uint32_t u, uint32_t s) const
+    {
+        const uint32_t limb[4] = {uint32_t(lo), uint32_t(lo >> 32), uint32_t(hi), uint32_t(hi >> 32)};
+        uint32_t r[7] = {};
+        uint64_t c = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            c += uint64_t(limb[i]) * u;
+            r[i] = uint32_t(c);
+            c >>= 32;
+        }
+        r[4] = uint32_t(c);
+        uint32_t w = s >> 5, b = s & 31;
+        if (w > 4)
+            return 0;
+        uint64_t x = r[w] | (uint64_t(r[w + 1]) << 32);
+        return b ? (x >> b) | (uint64_t(r[w + 2]) << (64 - b)) : x;
+    }
+};
+
+// n(n+1)/2 and n(n+1)(n+2)/6: what a unit accel and a unit jerk add up to
+// over n ticks
+inline uint64_t triangle(uint64_t n)
+{
+    return n * (n + 1) / 2;
+}
+inline uint64_t tetrahedron(uint64_t n)
+{
+    uint64_t t = triangle(n);
+    return (n % 3 == 1) ? t * ((n + 2) / 3) : (t / 3) * (n + 2);
+}
+
+// Symmetric trapezoid, evaluated in closed form from the tick index.
+// Ramps cover floor(aQ*n(n+1)/2) Q32 steps by tick n, the cruise vQ per
+// tick, so every distance is an exact integer expression and the profile
+// cannot drift however long the move is.
+struct TrapezoidProfile
+{
+    uint64_t aQ = 0;      // Q48 steps/tick²
+    uint64_t vQ = 0;      // Q32 steps/tick (== aQ * nAccel >> 16)
+    uint32_t nAccel = 0;  // ticks accelerating (== ticks decelerating)
+    uint32_t nCruise = 0; // ticks at vQ
+    uint32_t nTotal = 0;
+    uint64_t sAccelQ = 0; // distance at the end of the accel ramp
+    uint64_t sEndQ = 0;   // distance at nTotal, always >= totalSteps << 32
+
+    // Returns false if the request is degenerate (no steps, no speed/accel)
+    bool plan(uint32_t totalSteps, float vStepsPerTick, float aStepsPerTick2);
+
+    // First tick n > from with positionAt(n) >= sQ (event scheduler)
+    uint32_t tickReaching(uint64_t sQ, uint32_t from) const;
+
+    inline uint64_t positionAt(uint32_t n) const
+    {
+        if (n >= nTotal)
+            return sEndQ;
+        if (n <= nAccel)
+            return rampAt(n);
+        uint32_t m = nTotal - n;
+        if (m < nAccel)
+            return sEndQ - rampAt(m);
+        return sAccelQ + vQ * (n - nAccel);
+    }
+
+    // Distance moved during tick n, so positions are its running sum
+    inline uint64_t velocityAt(uint32_t n) const
+    {
+        if (n == 0 || n > nTotal)
+            return 0;
+        if (n <= nAccel)
+            return rampAt(n) - rampAt(n - 1);
+        uint32_t m = nTotal - n;
+        if (m < nAccel)
+            return rampAt(m + 1) - rampAt(m);
+        return vQ;
+    }
+
+    inline uint64_t rampAt(uint32_t n) const
+    {
+        return accelTimes(aQ, uint64_t(n) * (n + 1) / 2);
+    }
+
+    // +1 accelerating, 0 cruising/finished, -1 decelerating
+    inline int accelSignAt(uint32_t n) const
+    {
+        if (n >= nTotal)
+            return 0;
+        if (n < nAccel)
+            return +1;
+        return (nTotal - n < nAccel) ? -1 : 0;
+    }
+};
+
+// Jerk-limited 7-segment profile: acceleration ramps up at constant jerk,
+// may hold at aPeak, ramps back to zero, then cruise and a mirrored decel.
+// Segment lengths are whole ticks (rounded up, so no limit is exceeded) and
+// the jerk is then fitted, to 62 significant bits, so the move ends on the
+// target. Tick n accelerates by jerk times an integer, so every distance
+// is jerk times an exact integer polynomial of n: one wide product and a
+// shift per evaluation, and both schedulers agree.
+struct SCurveProfile
+{
+    uint64_t jerkQ = 0;    // steps/tick³ actually planned, Q(32 + jerkShift)
+    uint32_t jerkShift = 0;
+    double aPeak = 0;      // steps/tick² (reporting)
+    double vPeak = 0;      // steps/tick (reporting)
+    uint32_t nJerk = 0;    // ticks in each of the four jerk segments
+    uint32_t nHold = 0;    // ticks at constant +-aPeak
+    uint32_t nAccel = 0;   // 2 * nJerk + nHold (== ticks decelerating)
+    uint32_t nCruise = 0;
+    uint32_t nTotal = 0;
+    uint64_t sAccelQ = 0;  // distance at the end of the accel phase
+    uint64_t sCruiseQ = 0; // ... and of the cruise
+    uint64_t sEndQ = 0;    // always >= totalSteps << 32
+
+    // False if degenerate, or if the accel phase would run past
+    // MAX_JERK_RAMP_TICKS
+    bool plan(uint32_t totalSteps, float vStepsPerTick, float aStepsPerTick2, float jStepsPerTick3);
+    uint32_t tickReaching(uint64_t sQ, uint32_t from) const;
+
+    inline uint64_t positionAt(uint32_t n) const
+    {
+        if (n >= nTotal)
+            return sEndQ;
+        if (n <= nAccel)
+            return rampAt(n);
+        if (n - nAccel <= nCruise)
+            return sAccelQ + _vPeakW.mulShr(n - nAccel, jerkShift);
+        return sEndQ - rampAt(nTotal - n);
+    }
+
+    // Signed values at tick n: accel < 0 while decelerating
+    double velocityAt(uint32_t n) const;
+    double accelAt(uint32_t n) const;
+
+private:
+    // Accel phase in jerk units (distance = jerkQ * P): P and speed at the
+    // end of the jerk-up segment and of the hold, speed at the peak
+    uint64_t _p1 = 0, _w1 = 0, _p2 = 0, _w2 = 0, _w = 0;
+    Wide _vPeakW; // jerkQ * _w
+
+    uint64_t rampPoly(uint32_t n) const;
+    uint64_t rampSpeed(uint32_t n) const;
+    inline uint64_t rampAt(uint32_t n) const
+    {
+        return uint64_t(Wide::mul(int64_t(jerkQ), rampPoly(n)).shr(jerkShift));
+    }
+};
+
+// What a point-to-point plan runs: the S-curve when a jerk limit is given,
+// otherwise the exact-integer trapezoid.
+struct MoveProfile
+{
+    bool sCurve = false;
+    TrapezoidProfile trap;
+    SCurveProfile curve;
+
+    // jStepsPerTick3 <= 0 selects the trapezoid
+    bool plan(uint32_t totalSteps, float vStepsPerTick, float aStepsPerTick2, float jStepsPerTick3);
+
+    inline uint64_t positionAt(uint32_t n) const
+    {
+        return sCurve ? curve.positionAt(n) : trap.positionAt(n);
+    }
+    inline uint32_t tickReaching(uint64_t sQ, uint32_t from) const
+    {
+        return sCurve ? curve.tickReaching(sQ, from) : trap.tickReaching(sQ, from);
+    }
+    inline uint32_t totalTicks() const
+    {
+        return sCurve ? curve.nTotal : trap.nTotal;
+    }
+    // Ticks spent accelerating (== decelerating)
+    inline uint32_t rampTicks() const
+    {
+        return sCurve ? curve.nAccel : trap.nAccel;
+    }
+
+    // Reporting only (steps/tick, steps/tick²)
+    float velocityAt(uint32_t n) const;
+    float accelAt(uint32_t n) const;
+    float peakVelocity() const;
+    float peakAccel() const;
+};
+
+// What is left of a move that a same-direction follower took over while it
+// was still braking. The two run superposed from the hand-over: the
+// follower accelerates while this decelerates, so the joint passes from
+// one cruise speed to the other without stopping. Ticks are the
+// follower's (tick 0 = hand-over); positions are relative to fromQ.
+struct BlendTail
+{
+    MoveProfile profile; // the move handed over from
+    uint32_t offset = 0; // its tick index at the hand-over
+    uint64_t endQ = 0;   // its exact length, totalSteps << 32
+    uint64_t fromQ = 0;  // distance already counted before the hand-over
+
+    inline uint64_t positionAt(uint32_t k) const
+    {
+        uint64_t s = profile.positionAt(offset + k);
+        return (s < endQ ? s : endQ) - fromQ;
+    }
+    // First follower tick at which the tail adds nothing more
+    inline uint32_t endTick() const
+    {
+        uint32_t n = profile.totalTicks();
+        return n > offset ? n - offset : 0;
+    }
+    // tickReaching() of head + tail, head being the follower's profile
+    uint32_t tickReaching(const MoveProfile &head, uint64_t sQ, uint32_t from) const;
+};
+
+// One block of a blended path: a trapezoid entered at v0 and left at v1
+// rather than at rest, so consecutive blocks join without stopping. Phase
+// lengths are whole ticks and vPeak is refitted so the block ends exactly
+// on its length. Steps/tick units, double precision like SCurveProfile.
+struct LinkProfile
+{
+    double v0 = 0;
+    double vPeak = 0;
+    double v1 = 0;
+    double aUp = 0;   // v0 -> vPeak per tick (negative if vPeak < v0)
+    double aDown = 0; // vPeak -> v1 per tick (positive when slowing down)
+    uint32_t nAccel = 0;
+    uint32_t nCruise = 0;
+    uint32_t nDecel = 0;
+    uint32_t nTotal = 0;
+    double sAccel = 0;  // distance at the end of the first phase
+    double sCruise = 0; // ... and of the cruise
+    uint64_t sEndQ = 0; // exactly totalSteps << 32
+
+    // The join speeds are taken as given: the look-ahead only asks for
+    // what aMax can reach over the block. False if degenerate.
+    bool plan(uint32_t totalSteps, double fromV, double toV, double vMax, double aMax);
+    uint32_t tickReaching(uint64_t sQ, uint32_t from) const;
+
+    inline uint64_t positionAt(uint32_t n) const
+    {
+        if (n >= nTotal)
+            return sEndQ;
+        double t = double(n);
+        double s;
+        if (n <= nAccel)
+            s = t * (v0 + 0.5 * aUp * t);
+        else if (n - nAccel <= nCruise)
+            s = sAccel + vPeak * (t - nAccel);
+        else
+        {
+            t -= double(nAccel + nCruise);
+            s = sCruise + t * (vPeak - 0.5 * aDown * t);
+        }
+        return s > 0 ? uint64_t(s * double(Q32_ONE)) : 0;
+    }
+
+    double velocityAt(uint32_t n) const;
+    double accelAt(uint32_t n) const;
+};
+
+// Jog slew: ramp from v0Q toward vtQ at aQ (Q48) per tick, then hold vtQ.
+// Like the trapezoid it is evaluated from the tick index since retarget.
+struct RampProfile
+{
+    uint64_t v0Q = 0;
+    uint64_t vtQ = 0;
+    uint64_t aQ = 0;
+    uint32_t nRamp = 0; // ticks spent slewing
+    uint64_t sRampQ = 0;
+    bool up = true;
+
+    void plan(uint64_t fromVQ, uint64_t toVQ, uint64_t accelQ);
+
+    // First tick k > from with positionAt(k) >= sQ, TICK_NEVER if it stalls
+    uint32_t tickReaching(uint64_t sQ, uint32_t from) const;
+
+    inline uint64_t positionAt(uint32_t k) const
+    {
+        if (k > nRamp)
+            return sRampQ + vtQ * (k - nRamp);
+        uint64_t ramp = accelTimes(aQ, uint64_t(k) * (k + 1) / 2);
+        return up ? v0Q * k + ramp : v0Q * k - ramp;
+    }
+
+    inline uint64_t velocityAt(uint32_t k) const
+    {
+        if (k > nRamp)
+            return vtQ;
+        uint64_t dv = accelTimes(aQ, k);
+        return up ? v0Q + dv : v0Q - dv;
+    }
+
+    inline bool ramping(uint32_t k) const { return k < nRamp; }
+};
+
+// Jerk-limited jog slew: from speed v0 with acceleration a0 to vt, ramping
+// the acceleration at +-jerk and capping it at aMax, so every retarget is
+// joined with continuous acceleration. Three whole-tick segments (jerk,
+// hold, jerk) end with zero acceleration, then vt is held exactly. Speed,
+// accel and jerk are Q60 integers, each segment starting from the exact
+// state the one before left, so positions are exact integer sums.
+struct SCurveRamp
+{
+    uint64_t vtQ = 0;  // held after the slew, Q32 steps/tick
+    uint32_t kEnd = 0; // first tick of the hold
+    uint64_t sEndQ = 0;
+
+    // aMax or jMax <= 0 holds the current speed. vX/aX are Q60 steps/tick
+    // and steps/tick² (stateAt() of the plan being replaced), toV, aMax and
+    // jMax per tick.
+    void plan(int64_t vX, int64_t aX, double toV, double aMax, double jMax);
+
+    // First tick k > from with positionAt(k) >= sQ, TICK_NEVER if it stalls
+    uint32_t tickReaching(uint64_t sQ, uint32_t from) const;
+
+    inline uint64_t positionAt(uint32_t k) const
+    {
+        if (k >= kEnd)
+            return sEndQ + vtQ * (k - kEnd);
+        const Segment &g = segmentAt(k);
+        uint32_t u = k - g.k;
+        Wide s = g.s;
+        s += Wide::mul(g.v, u);
+        s += Wide::mul(g.a, triangle(u));
+        s += Wide::mul(g.j, tetrahedron(u));
+        int64_t q = s.toQ32();
+        return q > 0 ? uint64_t(q) : 0;
+    }
+
+    // Q60 speed and accel at tick k
+    void stateAt(uint32_t k, int64_t &vX, int64_t &aX) const;
+    double velocityAt(uint32_t k) const;
+    double accelAt(uint32_t k) const;
+    inline bool ramping(uint32_t k) const { return k < kEnd; }
+
+private:
+    struct Segment
+    {
+        uint32_t k;      // first tick
+        Wide s;          // Q60 distance before it
+        int64_t v, a, j; // Q60 state before it, constant jerk
+    };
+    Segment _seg[3] = {};
+
+    inline const Segment &segmentAt(uint32_t k) const
+    {
+        return _seg[k >= _seg[2].k ? 2 : (k >= _seg[1].k ? 1 : 0)];
+    }
+};
+
+// Jog/velocity-mode slew: the jerk-limited SCurveRamp when a jerk limit is
+// given, otherwise the linear RampProfile.
+struct JogProfile
+{
+    bool sCurve = false;
+    RampProfile linear;
+    SCurveRamp curve;
+
+    // Standstill, no slew in progress
+    void reset();
+    // Replan toward toV starting from the state at tick k of the current
+    // plan (k = 0 after reset). Units are per tick; jMax <= 0 is linear.
+    void retarget(uint32_t k, double toV, double aMax, double jMax);
+    // Re-anchor a finished slew at tick 0, holding its final speed
+    void rebase();
+
+    inline uint64_t positionAt(uint32_t k) const
+    {
+        return sCurve ? curve.positionAt(k) : linear.positionAt(k);
+    }
+    inline uint32_t tickReaching(uint64_t sQ, uint32_t from) const
+    {
+        return sCurve ? curve.tickReaching(sQ, from) : linear.tickReaching(sQ, from);
+    }
+    inline bool ramping(uint32_t k) const
+    {
+        return sCurve ? curve.ramping(k) : linear.ramping(k);
+    }
+    // First tick at which ramping() is false
+    uint32_t settleTick() const;
+
+    double velocityAt(uint32_t k) const; // steps/tick
+    double accelAt(uint32_t k) const;    // signed steps/tick²
+};
+
+// Input shaper: the commanded motion convolved with a few time-shifted
+// impulses whose sum cancels the residual vibration of one mode (hz,
+// damping ratio). ZV is the shortest (half a damped period); ZVD and EI
+// take a full period and tolerate a mode that is off by more.
+enum class ShaperType : uint8_t
+{
+    None,
+    ZV,
+    ZVD,
+    EI
+};
+
+struct InputShaper
+{
+    static constexpr uint8_t MAX_IMPULSES = 3;
+    uint8_t count = 0; // 0 = pass-through
+    float amp[MAX_IMPULSES] = {0};   // sum to 1
+    float delay[MAX_IMPULSES] = {0}; // seconds, first is 0
+
+    // False if hz <= 0 or damping is outside [0, 1) for a shaping type
+    bool design(ShaperType type, float hz, float damping);
+    // Seconds the shaped motion trails the command by at its end
+    inline float duration() const { return count ? delay[count - 1] : 0.0f; }
+};
+
+// Largest time scale k (0..1] at which n joints' velocity slice keeps to
+// their limits (any consistent units). Slowing time by 1/k scales every
+// speed by k and every accel by k², all joints alike, so the slice keeps
+// its direction in joint space. A limit of 0 or less is not checked.
+float sliceTimeScale(const float *speed, const float *accel,
+                     const float *speedLimit, const float *accelLimit, size_t n);
+
+#endif // MOTION_PROFILE_H
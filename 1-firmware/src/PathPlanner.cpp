@@ -0,0 +1,194 @@
+#include "PathPlanner.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+bool PathPlanner::add(const Waypoint &w, float deviationDeg, size_t window, uint32_t nowMs)
+{
+    auto &sm = StepperManager::instance();
+    uint32_t epoch, next;
+    bool running;
+    sm.pathProgress(epoch, next, running);
+    if (epoch != _epoch)
+    {
+        // dropped: what was planned is gone
+        _epoch = epoch;
+        _end = next;
+        _kicked = false;
+    }
+    bool joined = running || next != _end; // a block before this one is still to run
+    if (!joined)
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            _endPos[j] = sm.getTargetSteps(j);
+    if (_end - next >= window)
+        return false;
+
+    Block &b = block(_end);
+    float len2 = 0;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        int64_t to = (w.joints & (1UL << j)) ? w.target[j] : _endPos[j];
+        b.delta[j] = long(to - _endPos[j]);
+        b.unit[j] = float(b.delta[j]) / w.stepsPerDeg[j];
+        len2 += b.unit[j] * b.unit[j];
+    }
+    b.length = sqrtf(len2);
+    b.vNominal = INFINITY;
+    b.accel = INFINITY;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        if (b.delta[j] == 0)
+        {
+            b.unit[j] = 0;
+            continue;
+        }
+        b.unit[j] /= b.length;
+        // the path may go no faster than its slowest joint allows
+        float share = fabsf(b.unit[j]);
+        b.vNominal = fminf(b.vNominal, fabsf(w.speed[j]) / share);
+        b.accel = fminf(b.accel, fabsf(w.accel[j]) / share);
+    }
+    if (b.length > 0 && !(b.vNominal > 0 && b.accel > 0 && std::isfinite(b.vNominal)))
+        return false;
+    if (b.length == 0)
+        b.vNominal = b.accel = 0; // a stop, reported when reached
+
+    b.maxEntry = joined ? junctionSpeed(block(_end - 1), b, deviationDeg) : 0;
+    b.entry = 0;
+    b.loaded = 0;
+    b.id = w.id;
+    ++_end;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        _endPos[j] += b.delta[j];
+    _lastAddMs = nowMs;
+    return replan();
+}
+
+void PathPlanner::service(size_t window, uint32_t nowMs)
+{
+    auto &sm = StepperManager::instance();
+    uint32_t epoch, next;
+    bool running;
+    sm.pathProgress(epoch, next, running);
+    if (epoch != _epoch || running || next == _end)
+    {
+        _kicked = false;
+        return;
+    }
+    if (_kicked && next == _kickedAt)
+        return; // the start is on its way
+    if (_end - next >= window || nowMs - _lastAddMs >= START_DELAY_MS)
+    {
+        sm.startPath();
+        _kicked = true;
+        _kickedAt = next;
+    }
+}
+
+void PathPlanner::endPosition(int64_t out[CONFIG_JOINT_COUNT]) const
+{
+    auto &sm = StepperManager::instance();
+    uint32_t epoch, next;
+    bool running;
+    sm.pathProgress(epoch, next, running);
+    bool joined = epoch == _epoch && (running || next != _end);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        out[j] = joined ? _endPos[j] : sm.getTargetSteps(j);
+}
+
+// Fastest speed through the corner between two blocks whose arc, tangent
+// to both, stays within deviationDeg of the waypoint at the lower of the
+// two accel limits: v² = a·δ·sin(θ/2) / (1 − sin(θ/2)).
+float PathPlanner::junctionSpeed(const Block &from, const Block &to, float deviationDeg)
+{
+    if (from.length == 0 || to.length == 0)
+        return 0;
+    float cosTheta = 0; // of the angle between the blocks' backward and forward directions
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        float dot = from.unit[j] * to.unit[j];
+        if (dot < 0)
+            return 0; // this joint reverses: it has to stop
+        cosTheta -= dot;
+    }
+    float v = fminf(from.vNominal, to.vNominal);
+    if (cosTheta < -0.999999f)
+        return v; // straight on
+    float sinHalf = sqrtf(0.5f * (1.0f - cosTheta));
+    float a = fminf(from.accel, to.accel);
+    return fminf(v, sqrtf(a * deviationDeg * sinHalf / (1.0f - sinHalf)));
+}
+
+// Recompute the entry speed of every block not started yet and hand them
+// over. The first of them keeps the speed it was loaded with: it is what
+// the block running now ends at. If the ISR starts it meanwhile, go again
+// from the next one (so this ends once the window has run through).
+bool PathPlanner::replan()
+{
+    auto &sm = StepperManager::instance();
+    bool refused = false;
+    uint32_t refusedAt = 0;
+    for (;;)
+    {
+        uint32_t epoch, next;
+        bool running;
+        sm.pathProgress(epoch, next, running);
+        if (epoch != _epoch)
+            return false;
+        if (next == _end)
+            return true;
+        if (refused && next == refusedAt)
+            return false; // turned down for good, not overtaken
+
+        Block &head = block(next);
+        head.entry = running ? head.loaded : 0;
+
+        // backward: no faster than can still brake to a stop at the end
+        float v = 0;
+        for (uint32_t n = _end - 1; n != next; --n)
+        {
+            Block &b = block(n);
+            v = fminf(b.maxEntry, sqrtf(v * v + 2.0f * b.accel * b.length));
+            b.entry = v;
+        }
+        // forward: no faster than the block before can accelerate to
+        for (uint32_t n = next; n + 1 != _end; ++n)
+        {
+            Block &b = block(n);
+            Block &to = block(n + 1);
+            float reach = sqrtf(b.entry * b.entry + 2.0f * b.accel * b.length);
+            if (to.entry > reach)
+                to.entry = reach;
+        }
+
+        StepperManager::PathBlock out[StepperManager::PATH_CAPACITY];
+        size_t count = _end - next;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Block &b = block(next + i);
+            auto &pb = out[i];
+            long master = 0;
+            for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            {
+                pb.delta[j] = b.delta[j];
+                master = std::max(master, std::labs(b.delta[j]));
+            }
+            // deg of path -> master steps
+            float r = b.length > 0 ? float(master) / b.length : 0;
+            float exit = (next + i + 1 != _end) ? block(next + i + 1).entry : 0;
+            pb.vMax = b.vNominal * r;
+            pb.aMax = b.accel * r;
+            pb.vEntry = b.entry * r;
+            pb.vExit = exit * r;
+            pb.id = b.id;
+        }
+        if (sm.loadPath(epoch, next, out, count))
+        {
+            for (uint32_t n = next; n != _end; ++n)
+                block(n).loaded = block(n).entry;
+            return true;
+        }
+        refused = true;
+        refusedAt = next;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef PATH_PLANNER_H
+#define PATH_PLANNER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Config.h"
+#include "StepperManager.h"
+
+// Look-ahead for blended waypoint sequences (loop side). Each waypoint
+// adds a straight joint-space block from the one before. Where two blocks
+// meet, the junction speed is the fastest at which cutting the corner
+// stays within a deviation tolerance (the grbl junction rule, in degrees
+// of joint space); a joint that reverses stops there. A backward pass
+// then caps every entry speed so the window can still brake to a stop at
+// its last waypoint, and a forward pass caps it at what the accel limit
+// can reach from the block before. The plan is handed to StepperManager,
+// which runs the blocks back to back.
+class PathPlanner
+{
+public:
+    static constexpr size_t MAX_WINDOW = StepperManager::PATH_CAPACITY - 1;
+    // Blocks wait this long for more to join them before starting from rest
+    static constexpr uint32_t START_DELAY_MS = 50;
+
+    struct Waypoint
+    {
+        uint32_t joints;                      // bit j: target[j] is given
+        int64_t target[CONFIG_JOINT_COUNT];   // steps
+        float stepsPerDeg[CONFIG_JOINT_COUNT];
+        float speed[CONFIG_JOINT_COUNT];      // deg/s limits along the block
+        float accel[CONFIG_JOINT_COUNT];      // deg/s²
+        uint32_t id;
+    };
+
+    // Append a waypoint (joints not given stay where the last one left
+    // them). False if `window` (1..MAX_WINDOW) blocks already wait to be
+    // started or the limits are unusable.
+    bool add(const Waypoint &w, float deviationDeg, size_t window, uint32_t nowMs);
+
+    // Start waiting blocks from rest once the window is full or no
+    // waypoint came for START_DELAY_MS (call from the loop)
+    void service(size_t window, uint32_t nowMs);
+
+    // Where the next waypoint's block starts (steps): the last one added
+    // while blocks are still to run, else the joints' targets
+    void endPosition(int64_t out[CONFIG_JOINT_COUNT]) const;
+
+private:
+    struct Block
+    {
+        long delta[CONFIG_JOINT_COUNT];  // steps
+        float unit[CONFIG_JOINT_COUNT];  // direction, deg per deg of path
+        float length;                    // deg of joint space
+        float vNominal;                  // deg/s along the path
+        float accel;                     // deg/s²
+        float maxEntry;                  // junction speed into it
+        float entry;                     // planned entry speed
+        float loaded;                    // entry speed StepperManager has
+        uint32_t id;
+    };
+    Block _blocks[StepperManager::PATH_CAPACITY];
+    uint32_t _epoch = 0;
+    uint32_t _end = 0; // number of the next block to add
+    int64_t _endPos[CONFIG_JOINT_COUNT] = {0};
+    uint32_t _lastAddMs = 0;
+    bool _kicked = false; // startPath asked, ISR not through yet ...
+    uint32_t _kickedAt = 0; // ... with this block next
+
+    inline Block &block(uint32_t n) { return _blocks[n % StepperManager::PATH_CAPACITY]; }
+    static float junctionSpeed(const Block &from, const Block &to, float deviationDeg);
+    bool replan();
+};
+
+#endif // PATH_PLANNER_H
@@ -8,14 +8,38 @@ const uint8_t BUTTON_PINS[BUTTON_COUNT] = {
 
 // Emergency Stop uses PIN_ESTOP constant
 
+// External axes use the SD socket pads (42..47); the SD card is not used.
 // Limit switch pin assignments
 const uint8_t LIMIT_PINS[LIMIT_COUNT] = {
     10, 15, 32, 33,
-    40, 41};
+    40, 41,
+#if EXTERNAL_AXES >= 1
+    46,
+#endif
+#if EXTERNAL_AXES >= 2
+    47,
+#endif
+};
 
 // Stepper driver pins
-const uint8_t STEPPER_DIR_PINS[STEPPER_COUNT] = {26, 28, 27, 31, 30, 29};
-const uint8_t STEPPER_PULSE_PINS[STEPPER_COUNT] = {2, 4, 3, 9, 6, 5};
+const uint8_t STEPPER_DIR_PINS[STEPPER_COUNT] = {
+    26, 28, 27, 31, 30, 29,
+#if EXTERNAL_AXES >= 1
+    43,
+#endif
+#if EXTERNAL_AXES >= 2
+    45,
+#endif
+};
+const uint8_t STEPPER_PULSE_PINS[STEPPER_COUNT] = {
+    2, 4, 3, 9, 6, 5,
+#if EXTERNAL_AXES >= 1
+    42,
+#endif
+#if EXTERNAL_AXES >= 2
+    44,
+#endif
+};
 
 // Relay pin assignments
 const uint8_t RELAY_PINS[RELAY_COUNT] = {
@@ -15,14 +15,24 @@ enum : uint8_t
     PIN_ESTOP = 14
 };
 
+// === Axes ===
+// J1..J6 are the arm. External axes driven by the same step engine are
+// added at build time: -DEXTERNAL_AXES=1 adds J7 (linear track), 2 also
+// J8 (rotary table). Every per-joint table below grows with the count.
+#ifndef EXTERNAL_AXES
+#define EXTERNAL_AXES 0
+#endif
+static_assert(EXTERNAL_AXES >= 0 && EXTERNAL_AXES <= 2, "pins are assigned for J7 and J8 only");
+constexpr size_t ARM_JOINT_COUNT = 6;
+constexpr size_t STEPPER_COUNT = ARM_JOINT_COUNT + EXTERNAL_AXES;
+
 // === Limit Switches ===
-// J1..J6, all normally LOW
-constexpr size_t LIMIT_COUNT = 6;
+// One home switch per axis, all normally LOW
+constexpr size_t LIMIT_COUNT = STEPPER_COUNT;
 extern const uint8_t LIMIT_PINS[LIMIT_COUNT];
 
 // === Stepper Drivers ===
-// J1..J6: direction and step pins
-constexpr size_t STEPPER_COUNT = 6;
+// Direction and step pins per axis
 extern const uint8_t STEPPER_DIR_PINS[STEPPER_COUNT];
 extern const uint8_t STEPPER_PULSE_PINS[STEPPER_COUNT];
 
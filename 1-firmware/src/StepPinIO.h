@@ -0,0 +1,98 @@
+#ifndef STEP_PIN_IO_H
+#define STEP_PIN_IO_H
+
+#include <Arduino.h>
+
+// Register-level pin access for the step generator. Pins are resolved once
+// to their GPIO port's DR_SET / DR_CLEAR registers plus a bit mask, and the
+// ISR then drives any number of pins on a port with a single store.
+#ifdef ARDUINO
+struct StepPinIO
+{
+    static inline volatile uint32_t *setRegister(uint8_t pin) { return portSetRegister(pin); }
+    static inline volatile uint32_t *clearRegister(uint8_t pin) { return portClearRegister(pin); }
+    static inline uint32_t bitMask(uint8_t pin) { return digitalPinToBitMask(pin); }
+    static inline void write(volatile uint32_t *reg, uint32_t mask) { *reg = mask; }
+};
+#else
+// Host build: pins map onto fake copies of the Teensy 4.1 GPIO ports they
+// sit on (GPIO1..4, same bit), and every store is reported through onWrite,
+// so a test can count port writes per tick and check that step edges on one
+// port rise and fall together.
+struct StepPinIO
+{
+    static constexpr size_t PORTS = 4;
+    inline static volatile uint32_t regs[PORTS][2] = {}; // [port][0 = set, 1 = clear]
+    inline static void (*onWrite)(volatile uint32_t *reg, uint32_t mask) = nullptr;
+
+    // (GPIO port - 1) << 5 | bit, for digital pins 0..54
+    static inline uint8_t portBit(uint8_t pin)
+    {
+        static const uint8_t map[55] = {
+            0x03, 0x02, 0x64, 0x65, 0x66, 0x68, 0x2A, 0x31, 0x30, 0x2B, // 0-9
+            0x20, 0x22, 0x21, 0x23, 0x12, 0x13, 0x17, 0x16, 0x11, 0x10, // 10-19
+            0x1A, 0x1B, 0x18, 0x19, 0x0C, 0x0D, 0x1E, 0x1F, 0x52, 0x7F, // 20-29
+            0x57, 0x56, 0x2C, 0x67, 0x3D, 0x3C, 0x32, 0x33, 0x1C, 0x1D, // 30-39
+            0x14, 0x15, 0x4F, 0x4E, 0x4D, 0x4C, 0x51, 0x50, 0x78, 0x7B, // 40-49
+            0x7C, 0x76, 0x7A, 0x79, 0x7D};                              // 50-54
+        return map[pin];
+    }
+    static inline volatile uint32_t *setRegister(uint8_t pin) { return &regs[portBit(pin) >> 5][0]; }
+    static inline volatile uint32_t *clearRegister(uint8_t pin) { return &regs[portBit(pin) >> 5][1]; }
+    static inline uint32_t bitMask(uint8_t pin) { return 1UL << (portBit(pin) & 31); }
+    static inline void write(volatile uint32_t *reg, uint32_t mask)
+    {
+        *reg = mask;
+        if (onWrite)
+            onWrite(reg, mask);
+    }
+};
+#endif
+
+// A set of pins grouped by GPIO port: slot[i]/mask[i] locate pin i, and a
+// per-slot mask array can be flushed with one store per port.
+template <size_t N>
+struct StepPortMap
+{
+    size_t ports = 0;
+    volatile uint32_t *setReg[N];
+    volatile uint32_t *clearReg[N];
+    uint8_t slot[N];
+    uint32_t mask[N];
+
+    void build(const uint8_t *pins)
+    {
+        ports = 0;
+        for (size_t i = 0; i < N; ++i)
+        {
+            volatile uint32_t *reg = StepPinIO::setRegister(pins[i]);
+            size_t p = 0;
+            while (p < ports && setReg[p] != reg)
+                ++p;
+            if (p == ports)
+            {
+                setReg[p] = reg;
+                clearReg[p] = StepPinIO::clearRegister(pins[i]);
+                ++ports;
+            }
+            slot[i] = uint8_t(p);
+            mask[i] = StepPinIO::bitMask(pins[i]);
+        }
+    }
+
+    // Drive the masked pins high / low, one store per touched port
+    inline void set(const uint32_t *slotMasks) const
+    {
+        for (size_t p = 0; p < ports; ++p)
+            if (slotMasks[p])
+                StepPinIO::write(setReg[p], slotMasks[p]);
+    }
+    inline void clear(const uint32_t *slotMasks) const
+    {
+        for (size_t p = 0; p < ports; ++p)
+            if (slotMasks[p])
+                StepPinIO::write(clearReg[p], slotMasks[p]);
+    }
+};
+
+#endif // STEP_PIN_IO_H
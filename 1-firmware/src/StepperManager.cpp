@@ -1,6 +1,8 @@
 #include "StepperManager.h"
 #include <imxrt.h>
 #include <cmath>
+#include <algorithm>
+#include <climits>
 
 StepperManager *StepperManager::_inst = nullptr;
 
@@ -19,310 +21,2628 @@ StepperManager::StepperManager()
         _dirPins[j] = JOINT_CONFIG[j].dirPin;
         _isReversed[j] = JOINT_CONFIG[j].isReversed;
         _positions[j] = 0;
+        _pulseUs[j] = JOINT_CONFIG[j].stepPulseUs;
+        _dirSetupUs[j] = JOINT_CONFIG[j].dirSetupUs;
+        updateTiming(j);
     }
 }
 
-void StepperManager::begin(uint32_t freqHz)
+void StepperManager::begin(uint32_t freqHz, Scheduler mode)
 {
-    _dtSec = 1.0f / float(freqHz);
-    uint32_t periodUs = uint32_t(1e6f / float(freqHz));
+    _mode = mode;
     for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
     {
         pinMode(_stepPins[j], OUTPUT);
         pinMode(_dirPins[j], OUTPUT);
         digitalWrite(_stepPins[j], LOW);
         digitalWrite(_dirPins[j], LOW);
-        _motions[j].active = false;
-        _jogActive[j] = false;
-        _jogDir[j] = 0;
+        _axis.mode[j] = AxisIdle;
+        _axis.dir[j] = 0;
+        _axis.t0[j] = 0;
+        _axis.done[j] = 0;
+        _axis.total[j] = 0;
+        _axis.gate[j] = 0;
+        _axis.carry[j] = 0;
         _jogTargetV[j] = 0;
         _jogAccel[j] = 0;
-        _jogCurrentV[j] = 0;
+        _jogJerk[j] = 0;
+        _jogReverse[j] = false;
+        _jogRamp[j].reset();
+        _jogBaseQ[j] = 0;
+        _nextStep[j] = TICK_NEVER;
+        _dirOut[j] = _isReversed[j] ? +1 : -1; // the LOW written above
+        _slack[j] = _dirOut[j] > 0 ? _backlash[j] : 0;
+        _stepRaise[j] = 0;
+        newPlan(_lanes[j]);
+        _lanes[j].nextReady = false;
+        _queue[j].head = _queue[j].tail = 0;
+        _moveId[j] = 0;
+        resetShaper(j, _positions[j]);
+    }
+    _queued = 0;
+    _tailing = _tailOpen = 0;
+    _takingUp = 0;
+    _shaping = 0;
+    _shapeAt = 0;
+    _checkAt = 0;
+    _unguarded = 0;
+    _landing = _landArmed = _landBraking = 0;
+    _armTurn = 0;
+    _feedRate = _feedTarget;
+    _feedQ = toQ32(_feedRate);
+    _feedBaseQ = 0;
+    _feedAt = 0;
+    _finishedHead = _finishedTail = 0;
+    newPlan(_coordLane);
+    _coordLane.nextReady = false;
+    _plannerPeriod = 0;
+    _raisedJoints = 0;
+    _highJoints = 0;
+    _stepPort.build(_stepPins);
+    _dirPort.build(_dirPins);
+    _coord.active = false;
+    _coordNext = TICK_NEVER;
+    _coordCarry = 0;
+    _coordGate = 0;
+    _now = 0;
+
+    if (_mode == Scheduler::Event)
+    {
+        // GPT1 counts ticks directly: the compare value *is* the tick index
+        uint32_t prescale = (GPT_CLOCK_HZ + freqHz / 2) / freqHz;
+        if (prescale < 1)
+            prescale = 1;
+        else if (prescale > 4096)
+            prescale = 4096;
+        _tickHz = float(GPT_CLOCK_HZ) / float(prescale);
+        _shapePeriod = std::max<uint32_t>(1, uint32_t(_tickHz) / PLANNER_HZ);
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            updateTiming(j);
+            updateShaper(j);
+        }
+        _isrProfile.begin(uint32_t(CycleClock::hz() / _tickHz), false);
+
+        CCM_CCGR1 |= CCM_CCGR1_GPT1_BUS(CCM_CCGR_ON) | CCM_CCGR1_GPT1_SERIAL(CCM_CCGR_ON);
+        GPT1_CR = 0;
+        GPT1_PR = prescale - 1;
+        GPT1_SR = 0x3F;
+        GPT1_IR = GPT_IR_OF1IE | GPT_IR_OF2IE;
+        GPT1_CR = GPT_CR_EN | GPT_CR_ENMOD | GPT_CR_FRR | GPT_CR_CLKSRC(1);
+        attachInterruptVector(IRQ_GPT1, gptTrampoline);
+        NVIC_SET_PRIORITY(IRQ_GPT1, 16);
+        // no chords, but the jog checks still run in the planner IRQ
+        attachInterruptVector(IRQ_SOFTWARE, plannerTrampoline);
+        NVIC_SET_PRIORITY(IRQ_SOFTWARE, PLANNER_IRQ_PRIORITY);
+        NVIC_ENABLE_IRQ(IRQ_SOFTWARE);
+
+        noInterrupts();
+        _armedTick = GPT1_CNT;
+        armEarliest(_armedTick);
+        interrupts();
+        NVIC_ENABLE_IRQ(IRQ_GPT1);
+        _ticking = true;
+        return;
+    }
+
+    _tickHz = float(freqHz);
+    _shapePeriod = std::max<uint32_t>(1, freqHz / PLANNER_HZ); // sampled on the planner ticks
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        updateTiming(j);
+        updateShaper(j);
     }
+    _isrProfile.begin(uint32_t(CycleClock::hz() / _tickHz), true);
+
+    // The step ISR pends the planner every _plannerPeriod ticks; it runs
+    // once the ISR returns and the ISR preempts it.
+    _plannerPeriod = std::max<uint32_t>(1, freqHz / PLANNER_HZ);
+    _plannerCountdown = _plannerPeriod;
+    attachInterruptVector(IRQ_SOFTWARE, plannerTrampoline);
+    NVIC_SET_PRIORITY(IRQ_SOFTWARE, PLANNER_IRQ_PRIORITY);
+    NVIC_ENABLE_IRQ(IRQ_SOFTWARE);
+
+    uint32_t periodUs = uint32_t(1e6f / float(freqHz));
     _timer.begin(isrTrampoline, periodUs);
+    _ticking = true;
+}
+
+uint32_t StepperManager::setupTicks(float us) const
+{
+    uint32_t n = uint32_t(ceilf(us * _tickHz / 1e6f));
+    return n ? n : 1;
+}
+
+void StepperManager::setStepTiming(size_t joint, float pulseUs, float dirSetupUs)
+{
+    if (joint >= CONFIG_JOINT_COUNT)
+        return;
+    _pulseUs[joint] = fmaxf(pulseUs, 0.0f);
+    _dirSetupUs[joint] = fmaxf(dirSetupUs, 0.0f);
+    updateTiming(joint);
+}
+
+void StepperManager::setBacklash(size_t joint, long steps, float takeUpStepsPerSec)
+{
+    if (joint >= CONFIG_JOINT_COUNT)
+        return;
+    steps = std::max(steps, 0L);
+    noInterrupts();
+    if (steps != _backlash[joint])
+    {
+        _backlash[joint] = steps;
+        _slack[joint] = _dirOut[joint] > 0 ? steps : 0;
+        _takingUp &= ~(1UL << joint);
+    }
+    interrupts();
+    _takeUpRate[joint] = fmaxf(takeUpStepsPerSec, 0.0f);
+    updateTiming(joint);
+}
+
+bool StepperManager::setShaper(size_t joint, const InputShaper &shaper)
+{
+    if (joint >= CONFIG_JOINT_COUNT || shaper.duration() > MAX_SHAPER_SEC)
+        return false;
+    const InputShaper &cur = _shaper[joint];
+    bool same = shaper.count == cur.count;
+    for (uint8_t i = 0; same && i < shaper.count; ++i)
+        same = shaper.amp[i] == cur.amp[i] && shaper.delay[i] == cur.delay[i];
+    if (same)
+        return true;
+
+    uint32_t bit = 1UL << joint;
+    noInterrupts();
+    bool busy = _axis.mode[joint] != AxisIdle || ((_queued | _shaping | _takingUp) & bit);
+    if (!busy)
+    {
+        // the pin's edge gate moves with it
+        if (_shaped & bit)
+            _axis.gate[joint] = _shapeGate[joint];
+        else
+            _shapeGate[joint] = _axis.gate[joint];
+        _shaper[joint] = shaper;
+        _shaped = shaper.count ? (_shaped | bit) : (_shaped & ~bit);
+        updateShaper(joint);
+        resetShaper(joint, _positions[joint]);
+    }
+    interrupts();
+    return !busy;
+}
+
+// Whole ticks for one joint's timing (1 tick minimum: before begin() every
+// figure is a single tick). Word stores, so the ISR never sees a torn value.
+void StepperManager::updateTiming(size_t j)
+{
+    _pulseTicks[j] = setupTicks(_pulseUs[j]);
+    _minStepTicks[j] = _pulseTicks[j] + setupTicks(_pulseUs[j]);
+    _dirSetupTicks[j] = setupTicks(_dirSetupUs[j]);
+    float takeUp = _takeUpRate[j] > 0 ? ceilf(_tickHz / _takeUpRate[j]) : 0.0f;
+    _takeUpTicks[j] = std::max(_minStepTicks[j], uint32_t(fminf(takeUp, 1e9f)));
+
+    uint32_t span = 1;
+    for (size_t i = 0; i < CONFIG_JOINT_COUNT; ++i)
+        span = std::max({span, _minStepTicks[i], _dirSetupTicks[i]});
+    _gateSpan = span;
+}
+
+void StepperManager::setSoftLimits(size_t joint, int64_t minSteps, int64_t maxSteps,
+                                   float brakeStepsPerSec2)
+{
+    if (joint >= CONFIG_JOINT_COUNT)
+        return;
+    uint32_t bit = 1UL << joint;
+    noInterrupts();
+    _limitMin[joint] = minSteps;
+    _limitMax[joint] = maxSteps;
+    _brakeAccel[joint] = fmaxf(brakeStepsPerSec2, 0.0f);
+    _limited = (minSteps <= maxSteps) ? (_limited | bit) : (_limited & ~bit);
+    interrupts();
+}
+
+bool StepperManager::setFeedOverride(float scale)
+{
+    if (!(scale > 0.0f && scale <= FEED_OVERRIDE_MAX))
+        return false;
+    _feedTarget = scale;
+    wakeSoon(); // to start slewing
+    return true;
+}
+
+float StepperManager::feedOverride() const
+{
+    return _feedTarget;
+}
+
+// Taps in ticks and fixed-point weights (the last takes the rounding, so
+// they sum to SHAPE_ONE exactly and a held command is followed exactly).
+// Delays are clamped to what the sample ring holds; MAX_SHAPER_SEC fits at
+// any whole-kHz tick rate, and at any above 50 kHz.
+void StepperManager::updateShaper(size_t j)
+{
+    const InputShaper &s = _shaper[j];
+    uint32_t limit = (SHAPE_HISTORY - 2) * _shapePeriod;
+    int64_t rest = SHAPE_ONE;
+    for (uint8_t i = 0; i < s.count; ++i)
+    {
+        uint32_t d = uint32_t(lroundf(s.delay[i] * _tickHz));
+        _shapeDelay[j][i] = std::min(d, limit) + _shapePeriod;
+        _shapeWeight[j][i] = (i + 1 < s.count) ? int64_t(lroundf(s.amp[i] * float(SHAPE_ONE))) : rest;
+        rest -= _shapeWeight[j][i];
+    }
+    _shapeTaps[j] = s.count;
+    _shapeSpan[j] = s.count ? (_shapeDelay[j][s.count - 1] + _shapePeriod - 1) / _shapePeriod : 0;
+}
+
+// The command has been at `pos` for as long as the ring reaches, and the
+// pin is there too
+void StepperManager::resetShaper(size_t j, int64_t pos)
+{
+    for (size_t i = 0; i < SHAPE_HISTORY; ++i)
+        _shapeHist[j][i] = pos;
+    _shapeOut[j] = pos;
+    _shapeQuiet[j] = SHAPE_HISTORY;
+    _shaping &= ~(1UL << j);
 }
 
 void StepperManager::end()
 {
+    _ticking = false;
+    if (_mode == Scheduler::Event)
+    {
+        NVIC_DISABLE_IRQ(IRQ_GPT1);
+        NVIC_DISABLE_IRQ(IRQ_SOFTWARE);
+        GPT1_CR = 0;
+        return;
+    }
     _timer.end();
+    NVIC_DISABLE_IRQ(IRQ_SOFTWARE);
+    _plannerPeriod = 0;
 }
 
-bool StepperManager::startMotion(size_t joint,
+uint32_t StepperManager::currentTick() const
+{
+    return (_mode == Scheduler::Event) ? GPT1_CNT : _now;
+}
+
+// ——— Staged commit ————————————————————————————————————————————
+// Plans are built in _stage[_stageWrite] from loop context; commit()
+// publishes that buffer and the ISR applies it at the start of one tick.
+
+StepperManager::StagedSet &StepperManager::stage()
+{
+    return _stage[_stageWrite];
+}
+
+void StepperManager::stageDiscard()
+{
+    StagedSet &st = stage();
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        st.axis[j].kind = StagedAxis::Keep;
+    st.coordinated = false;
+    st.path = false;
+}
+
+bool StepperManager::stageMotion(size_t joint,
                                  long deltaSteps,
                                  float vStepsPerSec,
-                                 float aStepsPerSec2)
+                                 float aStepsPerSec2,
+                                 float jStepsPerSec3)
 {
     if (joint >= CONFIG_JOINT_COUNT || deltaSteps == 0)
         return (deltaSteps == 0);
+    if (_tickHz <= 0)
+        return false;
 
-    // cancel jog on this joint
-    _jogActive[joint] = false;
+    auto &sa = stage().axis[joint];
+    if (!planMotion(joint, sa.motion, deltaSteps, vStepsPerSec, aStepsPerSec2, jStepsPerSec3))
+        return false;
+    sa.kind = StagedAxis::Move;
+    return true;
+}
 
-    auto &mp = _motions[joint];
-    mp.joint = joint;
+bool StepperManager::planMotion(size_t joint, MotionPlan &mp, long deltaSteps,
+                                float vStepsPerSec, float aStepsPerSec2, float jStepsPerSec3)
+{
     mp.dir = (deltaSteps > 0 ? +1 : -1);
-    mp.startPos = _positions[joint];
-    mp.totalSteps = std::llabs(deltaSteps);
-    mp.doneSteps = 0;
-    mp.vMax = fabsf(vStepsPerSec);
-    mp.aMax = fabsf(aStepsPerSec2);
+    mp.totalSteps = std::labs(deltaSteps);
+    if (!mp.profile.plan(uint32_t(mp.totalSteps),
+                         fabsf(vStepsPerSec) / _tickHz,
+                         fabsf(aStepsPerSec2) / (_tickHz * _tickHz),
+                         fabsf(jStepsPerSec3) / (_tickHz * _tickHz * _tickHz)))
+        return false;
+    mp.vMax = mp.profile.peakVelocity() * _tickHz;
+    mp.aMax = mp.profile.peakAccel() * _tickHz * _tickHz;
+    if (mp.vMax > maxStepRate(joint))
+        ++_stats[joint].fastPlans;
+    return true;
+}
+
+bool StepperManager::stageCoordinated(const long deltaSteps[CONFIG_JOINT_COUNT],
+                                      const float vStepsPerSec[CONFIG_JOINT_COUNT],
+                                      const float aStepsPerSec2[CONFIG_JOINT_COUNT],
+                                      const float jStepsPerSec3[CONFIG_JOINT_COUNT],
+                                      float durationSec)
+{
+    if (_tickHz <= 0)
+        return false;
 
-    float tA_full = mp.vMax / mp.aMax;
-    float dA_full = 0.5f * mp.aMax * tA_full * tA_full;
-    if (mp.totalSteps < 2 * dA_full)
+    long L = 0;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        L = std::max(L, std::labs(deltaSteps[j]));
+    if (L == 0)
+        return true;
+
+    // master limits: the tightest joint, scaled by its share of the path
+    // (a joint without a jerk limit does not constrain the master's)
+    float vM = INFINITY, aM = INFINITY, jM = INFINITY;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
     {
-        float vPeak = sqrtf(mp.totalSteps * mp.aMax);
-        mp.vMax = vPeak;
-        mp.tAccel = vPeak / mp.aMax;
-        mp.tCruise = 0;
+        if (deltaSteps[j] == 0)
+            continue;
+        float r = float(L) / float(std::labs(deltaSteps[j]));
+        vM = fminf(vM, fabsf(vStepsPerSec[j]) * r);
+        aM = fminf(aM, fabsf(aStepsPerSec2[j]) * r);
+        if (jStepsPerSec3 && jStepsPerSec3[j] > 0)
+            jM = fminf(jM, jStepsPerSec3[j] * r);
     }
-    else
+    if (std::isinf(jM))
+        jM = 0;
+
+    StagedSet &st = stage();
+    auto &cp = st.coord;
+    if (!cp.profile.plan(uint32_t(L), vM / _tickHz, aM / (_tickHz * _tickHz),
+                         jM / (_tickHz * _tickHz * _tickHz)))
+        return false;
+    if (durationSec > 0 && !stretchProfile(cp.profile, uint32_t(L), vM, aM, jM, durationSec))
+        return false;
+    cp.masterSteps = L;
+    cp.vMax = cp.profile.peakVelocity() * _tickHz;
+    cp.aMax = cp.profile.peakAccel() * _tickHz * _tickHz;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
     {
-        mp.tAccel = tA_full;
-        mp.tCruise = (mp.totalSteps - 2 * dA_full) / mp.vMax;
+        cp.delta[j] = std::labs(deltaSteps[j]);
+        cp.dir[j] = (deltaSteps[j] >= 0 ? +1 : -1);
+        if (cp.delta[j] == 0)
+            continue;
+        // members drop anything staged for them individually
+        st.axis[j].kind = StagedAxis::Keep;
+        if (cp.vMax * float(cp.delta[j]) / float(L) > maxStepRate(j))
+            ++_stats[j].fastPlans;
     }
-    mp.tTotal = 2 * mp.tAccel + mp.tCruise;
-    mp.elapsed = 0;
-    mp.stepAcc = 0;
-    mp.currentV = 0;
-    mp.active = true;
+    st.coordinated = true;
+    return true;
+}
 
-    bool raw = (mp.dir > 0);
-    bool fin = raw ^ _isReversed[joint];
-    digitalWriteFast(_dirPins[joint], fin ? HIGH : LOW);
+// Replan p (already planned at the limits v/a/j, steps/s units) to last
+// durationSec. Running a profile k times slower is the same shape with
+// v/k, a/k², j/k³; whole-tick segment rounding leaves it a tick or two
+// off, so k is refined from the planned length.
+bool StepperManager::stretchProfile(MoveProfile &p, uint32_t steps, float v, float a, float j,
+                                    float durationSec) const
+{
+    double want = double(durationSec) * _tickHz;
+    if (double(p.totalTicks()) > want + 1.0)
+        return false; // limits cannot make it in time
+    double k = 1.0;
+    for (int i = 0; i < 4 && fabs(double(p.totalTicks()) - want) > 1.0; ++i)
+    {
+        k *= want / double(p.totalTicks());
+        double vk = v / (k * _tickHz);
+        double ak = a / (k * k * _tickHz * _tickHz);
+        double jk = j / (k * k * k * _tickHz * _tickHz * _tickHz);
+        if (!p.plan(steps, float(vk), float(ak), float(jk)))
+            return false;
+    }
     return true;
 }
 
-bool StepperManager::startJog(size_t joint,
+bool StepperManager::stageJog(size_t joint,
                               int dir,
                               float vStepsPerSec,
-                              float aStepsPerSec2)
+                              float aStepsPerSec2,
+                              float jStepsPerSec3,
+                              bool guarded)
 {
     if (joint >= CONFIG_JOINT_COUNT)
         return false;
 
-    // cancel position move on this joint
-    _motions[joint].active = false;
+    auto &sa = stage().axis[joint];
+    sa.kind = StagedAxis::JogStart;
+    sa.jogV = (dir >= 0 ? +1 : -1) * jogSpeed(joint, vStepsPerSec);
+    sa.jogA = fabsf(aStepsPerSec2);
+    sa.jogJ = fabsf(jStepsPerSec3);
+    sa.guarded = guarded;
+    return true;
+}
 
-    _jogActive[joint] = true;
-    _jogDir[joint] = (dir >= 0 ? +1 : -1);
-    _jogTargetV[joint] = fabsf(vStepsPerSec);
-    _jogAccel[joint] = fabsf(aStepsPerSec2);
-    _jogCurrentV[joint] = 0;
-    _jogRem[joint] = 0;
+void StepperManager::stageJogTarget(size_t joint,
+                                    float vStepsPerSec,
+                                    float aStepsPerSec2,
+                                    float jStepsPerSec3,
+                                    bool guarded)
+{
+    if (joint >= CONFIG_JOINT_COUNT)
+        return;
 
-    bool raw = (_jogDir[joint] > 0);
-    bool fin = raw ^ _isReversed[joint];
-    digitalWriteFast(_dirPins[joint], fin ? HIGH : LOW);
-    return true;
+    auto &sa = stage().axis[joint];
+    sa.kind = StagedAxis::JogTarget;
+    sa.jogV = copysignf(jogSpeed(joint, vStepsPerSec), vStepsPerSec);
+    sa.jogA = fabsf(aStepsPerSec2);
+    sa.jogJ = fabsf(jStepsPerSec3);
+    sa.guarded = guarded;
 }
 
-void StepperManager::setJogTarget(size_t joint,
-                                  float vStepsPerSec,
-                                  float aStepsPerSec2)
+void StepperManager::stageJogTo(size_t joint,
+                                int64_t targetSteps,
+                                float vStepsPerSec,
+                                float aStepsPerSec2,
+                                float jStepsPerSec3,
+                                uint32_t id)
 {
     if (joint >= CONFIG_JOINT_COUNT)
         return;
 
-    // enter jog mode if not already
-    if (!_jogActive[joint])
+    auto &sa = stage().axis[joint];
+    sa.kind = StagedAxis::JogTo;
+    sa.jogV = jogSpeed(joint, vStepsPerSec);
+    sa.jogA = fabsf(aStepsPerSec2);
+    sa.jogJ = fabsf(jStepsPerSec3);
+    sa.guarded = true;
+    sa.landAt = targetSteps;
+    sa.landId = id;
+}
+
+// A jog has no end position to catch up to, so a speed the step line cannot
+// carry is clamped (and counted) rather than left to build up a backlog
+float StepperManager::jogSpeed(size_t joint, float vStepsPerSec)
+{
+    float v = fabsf(vStepsPerSec), vMax = maxStepRate(joint);
+    if (v <= vMax)
+        return v;
+    ++_stats[joint].fastPlans;
+    return vMax;
+}
+
+// Publish the staged buffer. A previous commit the ISR has not consumed
+// yet is at most one tick old, so wait for it rather than merge.
+bool StepperManager::commit()
+{
+    if (_tickHz <= 0)
+    {
+        stageDiscard();
+        return false;
+    }
+    takeStage();
+
+    uint8_t published = _stageWrite;
+    _stageWrite ^= 1;
+    stageDiscard(); // the other buffer was consumed: start it empty
+    __asm__ volatile("" ::: "memory");
+    _stagePending = int8_t(published);
+    wakeSoon(); // to take it
+    return true;
+}
+
+// Loop context: see the commit in flight applied. The ISR takes it on its
+// next tick; with no tick source running (before begin(), after end()), or
+// none within STAGE_WAIT_US, it is applied here with interrupts off.
+void StepperManager::takeStage()
+{
+    uint32_t start = micros();
+    while (_stagePending >= 0)
     {
-        startJog(joint, (vStepsPerSec >= 0 ? +1 : -1),
-                 fabsf(vStepsPerSec), fabsf(aStepsPerSec2));
+        if (_ticking && micros() - start < STAGE_WAIT_US)
+            continue;
+        noInterrupts();
+        uint32_t changed = 0;
+        if (_stagePending >= 0)
+        {
+            // the event ISR's _now is its last wake, maybe long past
+            uint32_t saved = _now;
+            if (_mode == Scheduler::Event)
+                _now = GPT1_CNT;
+            changed = applyStage();
+            _now = saved;
+        }
+        interrupts();
+        if (changed)
+            rescheduleAll();
         return;
     }
+}
+
+// Event scheduler: make sure the ISR runs on the next tick (loop context)
+void StepperManager::wakeSoon()
+{
+    if (_mode != Scheduler::Event)
+        return;
+    noInterrupts();
+    uint32_t t = GPT1_CNT + 1;
+    if (int32_t(t - _armedTick) < 0)
+    {
+        _armedTick = t;
+        GPT1_OCR1 = t;
+        if (int32_t(t - GPT1_CNT) <= 0)
+            NVIC_SET_PENDING(IRQ_GPT1);
+    }
+    interrupts();
+}
+
+// ISR, at the start of tick _now: swap every staged axis in together.
+// Returns the joints whose plan changed (bit j) so the event scheduler can
+// recompute their next edge.
+uint32_t StepperManager::applyStage()
+{
+    StagedSet &st = _stage[_stagePending];
+    _stagePending = -1;
+
+    uint32_t vt = feedTickAt(_now); // moves start on the feed clock
+    uint32_t changed = 0;
+    uint32_t dirSet[CONFIG_JOINT_COUNT] = {0};
+    uint32_t dirClear[CONFIG_JOINT_COUNT] = {0};
+    auto queueDir = [&](size_t j, int dir)
+    {
+        if (_shaped & (1UL << j))
+            return; // its pin turns when the shaper gets there
+        bool fin = (dir > 0) ^ _isReversed[j];
+        (fin ? dirSet : dirClear)[_dirPort.slot[j]] |= _dirPort.mask[j];
+        if (dir != _dirOut[j])
+        {
+            _dirOut[j] = dir;
+            holdGate(_axis.gate[j], _dirSetupTicks[j]); // driver dir setup
+        }
+        armTakeUp(j);
+    };
+
+    if (st.coordinated)
+    {
+        auto &cp = _coord;
+        endCoordinated(); // members of a move still running fall idle
+        dropPath();
+        cp = st.coord;
+        cp.masterDone = 0;
+        cp.t0 = vt;
+        cp.minStepTicks = 1;
+        _coordCarry = 0;
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            cp.err[j] = cp.masterSteps / 2; // centre the minor-axis steps along the master
+            cp.startPos[j] = _positions[j];
+            if (cp.delta[j] == 0)
+                continue;
+            // coordinated members drop any independent move/jog
+            dropQueue(j);
+            _axis.mode[j] = AxisCoord;
+            queueDir(j, cp.dir[j]);
+            changed |= 1UL << j;
+            // the master steps no faster, and no sooner, than any member may
+            cp.minStepTicks = std::max(cp.minStepTicks, _minStepTicks[j]);
+            if (!gateOpen(_axis.gate[j]))
+                holdGate(_coordGate, _axis.gate[j] - _now);
+        }
+        cp.active = true;
+        newPlan(_coordLane);
+    }
+
+    if (st.path && !_coord.active)
+    {
+        startPathBlock(vt);
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            if (inCoordinated(j))
+                changed |= 1UL << j;
+    }
+
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        const auto &sa = st.axis[j];
+        if (sa.kind == StagedAxis::Keep)
+            continue;
+        changed |= 1UL << j;
+        if (inCoordinated(j))
+        {
+            endCoordinated();
+            dropPath();
+        }
+        dropQueue(j);
+
+        if (sa.kind == StagedAxis::Move)
+        {
+            auto &mp = _motions[j];
+            mp = sa.motion;
+            mp.startPos = _positions[j];
+            _axis.mode[j] = AxisMove;
+            _axis.dir[j] = int8_t(mp.dir);
+            _axis.t0[j] = vt;
+            _axis.done[j] = 0;
+            _axis.total[j] = mp.totalSteps;
+            _axis.carry[j] = 0; // restart from the steps actually emitted
+            newPlan(_lanes[j]);
+            queueDir(j, mp.dir);
+        }
+        else
+        {
+            uint32_t bit = 1UL << j;
+            _unguarded = sa.guarded ? (_unguarded & ~bit) : (_unguarded | bit);
+            _landing &= ~bit;
+            _landArmed &= ~bit;
+            _landBraking &= ~bit;
+            float v = sa.jogV;
+            if (sa.kind == StagedAxis::JogTo)
+            {
+                int64_t at = sa.landAt;
+                if (_limited & bit)
+                    at = std::min(std::max(at, _limitMin[j]), _limitMax[j]);
+                if (at == _positions[j] && _axis.mode[j] != AxisJog)
+                {
+                    reportFinished(j, sa.landId); // there already, and still
+                    continue;
+                }
+                _landing |= bit;
+                _landAt[j] = at;
+                _landSpeed[j] = v;
+                _landId[j] = sa.landId;
+                if (at < _positions[j])
+                    v = -v;
+            }
+            if (sa.kind == StagedAxis::JogStart || _axis.mode[j] != AxisJog)
+            {
+                startJogNow(j, v, sa.jogA, sa.jogJ);
+                queueDir(j, _axis.dir[j]);
+            }
+            else
+                retargetJog(j, v, sa.jogA, sa.jogJ);
+        }
+    }
 
-    // update direction pin only if sign changed
-    int newDir = (vStepsPerSec >= 0 ? +1 : -1);
-    if (newDir != _jogDir[joint])
+    // all new directions settle together, a full tick before any edge
+    _dirPort.set(dirSet);
+    _dirPort.clear(dirClear);
+    return changed;
+}
+
+bool StepperManager::startMotion(size_t joint,
+                                 long deltaSteps,
+                                 float vStepsPerSec,
+                                 float aStepsPerSec2,
+                                 float jStepsPerSec3)
+{
+    if (deltaSteps == 0)
+        return joint < CONFIG_JOINT_COUNT;
+    if (!stageMotion(joint, deltaSteps, vStepsPerSec, aStepsPerSec2, jStepsPerSec3))
+    {
+        stageDiscard();
+        return false;
+    }
+    return commit();
+}
+
+bool StepperManager::startCoordinated(const long deltaSteps[CONFIG_JOINT_COUNT],
+                                      const float vStepsPerSec[CONFIG_JOINT_COUNT],
+                                      const float aStepsPerSec2[CONFIG_JOINT_COUNT],
+                                      const float jStepsPerSec3[CONFIG_JOINT_COUNT],
+                                      float durationSec)
+{
+    if (!stageCoordinated(deltaSteps, vStepsPerSec, aStepsPerSec2, jStepsPerSec3, durationSec))
     {
-        _jogDir[joint] = newDir;
-        bool raw = (_jogDir[joint] > 0);
-        bool fin = raw ^ _isReversed[joint];
-        digitalWriteFast(_dirPins[joint], fin ? HIGH : LOW);
+        stageDiscard();
+        return false;
     }
-    _jogTargetV[joint] = fabsf(vStepsPerSec);
-    _jogAccel[joint] = fabsf(aStepsPerSec2);
+    return commit();
+}
+
+bool StepperManager::startJog(size_t joint,
+                              int dir,
+                              float vStepsPerSec,
+                              float aStepsPerSec2,
+                              float jStepsPerSec3,
+                              bool guarded)
+{
+    if (!stageJog(joint, dir, vStepsPerSec, aStepsPerSec2, jStepsPerSec3, guarded))
+        return false;
+    return commit();
+}
+
+void StepperManager::setJogTarget(size_t joint,
+                                  float vStepsPerSec,
+                                  float aStepsPerSec2,
+                                  float jStepsPerSec3,
+                                  bool guarded)
+{
+    if (joint >= CONFIG_JOINT_COUNT)
+        return;
+    stageJogTarget(joint, vStepsPerSec, aStepsPerSec2, jStepsPerSec3, guarded);
+    commit();
+}
+
+// ISR (applyStage): enter jog mode from rest; vStepsPerSec is signed
+void StepperManager::startJogNow(size_t joint, float vStepsPerSec, float aStepsPerSec2,
+                                 float jStepsPerSec3)
+{
+    _axis.dir[joint] = (vStepsPerSec >= 0 ? +1 : -1);
+    _jogTargetV[joint] = vStepsPerSec;
+    _jogAccel[joint] = aStepsPerSec2;
+    _jogJerk[joint] = jStepsPerSec3;
+    _jogReverse[joint] = false;
+    _jogRamp[joint].reset();
+    _jogRamp[joint].retarget(0,
+                             fabsf(vStepsPerSec) / _tickHz,
+                             aStepsPerSec2 / (_tickHz * _tickHz),
+                             jStepsPerSec3 / (double(_tickHz) * _tickHz * _tickHz));
+    _axis.t0[joint] = _now;
+    _jogBaseQ[joint] = 0;
+    _axis.done[joint] = 0;
+    _axis.carry[joint] = 0;
+    _axis.mode[joint] = AxisJog;
+    _landArmed &= ~(1UL << joint);
+    newPlan(_lanes[joint]);
+}
+
+// ISR (applyStage): vStepsPerSec is signed. A target against the current
+// direction brakes to zero first; stepJoint flips the dir pin once stopped
+// (reverseJog).
+void StepperManager::retargetJog(size_t joint, float vStepsPerSec, float aStepsPerSec2,
+                                 float jStepsPerSec3)
+{
+    double a = aStepsPerSec2 / (_tickHz * _tickHz);
+    double jerk = jStepsPerSec3 / (double(_tickHz) * _tickHz * _tickHz);
+
+    int want = (vStepsPerSec >= 0 ? +1 : -1);
+    bool reverse = (vStepsPerSec != 0 && want != _axis.dir[joint]);
+    _jogTargetV[joint] = vStepsPerSec;
+    _jogAccel[joint] = aStepsPerSec2;
+    _jogJerk[joint] = jStepsPerSec3;
+    _jogReverse[joint] = reverse;
+    double vt = reverse ? 0.0 : fabsf(vStepsPerSec) / _tickHz;
+
+    // Re-anchor the ramp at this tick: carry the speed, acceleration and
+    // distance not yet emitted so retargets never lose a step. Event mode
+    // may owe whole steps here (their edge is still scheduled).
+    uint32_t now = _now;
+    if (int32_t(now - _axis.t0[joint]) < 0)
+        now = _axis.t0[joint]; // still in the dir-setup wait: stay at rest until then
+    uint32_t k = now - _axis.t0[joint];
+    uint64_t s = _jogBaseQ[joint] + _jogRamp[joint].positionAt(k);
+    _jogRamp[joint].retarget(k, vt, a, jerk);
+    _jogBaseQ[joint] = s - (uint64_t(_axis.done[joint]) << Q32_SHIFT);
+    _axis.t0[joint] = now;
+    _landArmed &= ~(1UL << joint);
+    newPlan(_lanes[joint]);
+    _axis.done[joint] = 0;
 }
 
 void StepperManager::setJogTargetsAll(const float vStepsPerSec[CONFIG_JOINT_COUNT],
-                                      const float aStepsPerSec2[CONFIG_JOINT_COUNT])
+                                      const float aStepsPerSec2[CONFIG_JOINT_COUNT],
+                                      const float jStepsPerSec3[CONFIG_JOINT_COUNT])
 {
     for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
-        setJogTarget(j, vStepsPerSec[j], aStepsPerSec2[j]);
+        stageJogTarget(j, vStepsPerSec[j], aStepsPerSec2[j], jStepsPerSec3 ? jStepsPerSec3[j] : 0.0f);
+    commit();
+}
+
+void StepperManager::jogTo(size_t joint,
+                           int64_t targetSteps,
+                           float vStepsPerSec,
+                           float aStepsPerSec2,
+                           float jStepsPerSec3,
+                           uint32_t id)
+{
+    if (joint >= CONFIG_JOINT_COUNT)
+        return;
+    stageJogTo(joint, targetSteps, vStepsPerSec, aStepsPerSec2, jStepsPerSec3, id);
+    commit();
 }
 
-void StepperManager::setAllJogTargetsZero(float aStepsPerSec2)
+void StepperManager::setAllJogTargetsZero(float aStepsPerSec2, float jStepsPerSec3)
 {
     for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
     {
-        setJogTarget(j, 0.0f, aStepsPerSec2);
+        stageJogTarget(j, 0.0f, aStepsPerSec2, jStepsPerSec3);
     }
+    commit();
 }
 
+// Stops at once, with no decel: a jog committed just before is stopped
+// too, and a jog that was landing on a position lands nowhere
 void StepperManager::stopJog(size_t joint)
 {
     if (joint < CONFIG_JOINT_COUNT)
-        _jogActive[joint] = false;
+    {
+        uint32_t bit = 1UL << joint;
+        takeStage();
+        noInterrupts();
+        if (_axis.mode[joint] == AxisJog)
+            _axis.mode[joint] = AxisIdle;
+        _landing &= ~bit;
+        _landArmed &= ~bit;
+        _landBraking &= ~bit;
+        interrupts();
+        reschedule(joint);
+    }
 }
 
 void StepperManager::emergencyStop()
 {
+    noInterrupts();
+    _stagePending = -1; // a commit not yet taken is dropped too
+    _coord.active = false;
     for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
     {
-        _jogActive[j] = false;
-        _motions[j].active = false;
+        _axis.mode[j] = AxisIdle;
+        dropQueue(j);
+    }
+    dropPath();
+    _landing = _landArmed = _landBraking = 0;
+    _takingUp = 0; // the play stays where the last edge left it
+    // a shaped joint stops where its pin is, not where its command had got to
+    ++_seq;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        if (!(_shaped & (1UL << j)))
+            continue;
+        _positions[j] = _shapeOut[j];
+        resetShaper(j, _shapeOut[j]);
     }
+    ++_seq;
+    interrupts();
+    rescheduleAll();
 }
 
 bool StepperManager::isIdle() const
 {
+    return _pathNext == _pathEnd && jointsIdle() && !_takingUp && !_shaping;
+}
+
+bool StepperManager::jointsIdle() const
+{
+    if (_coord.active || _queued)
+        return false;
     for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
-        if (_jogActive[j] || _motions[j].active)
+        if (_axis.mode[j] != AxisIdle)
             return false;
     return true;
 }
 
-void StepperManager::resetPosition(size_t j, long pos)
+void StepperManager::resetPosition(size_t j, int64_t pos)
 {
     if (j < CONFIG_JOINT_COUNT)
     {
         noInterrupts();
+        ++_seq;
         _positions[j] = pos;
+        if (_shaped & (1UL << j))
+            resetShaper(j, pos);
+        ++_seq;
         interrupts();
     }
 }
 
-long StepperManager::getPosition(size_t j) const
+float StepperManager::maxStepRate(size_t joint) const
 {
-    long p = 0;
-    if (j < CONFIG_JOINT_COUNT)
-    {
-        noInterrupts();
-        p = _positions[j];
-        interrupts();
-    }
-    return p;
+    return joint < CONFIG_JOINT_COUNT ? _tickHz / float(_minStepTicks[joint]) : 0.0f;
 }
 
-long StepperManager::getTargetSteps(size_t j) const
+void StepperManager::getStepStats(size_t j, StepStats &out) const
 {
-    const auto &mp = _motions[j];
-    return mp.active ? (mp.startPos + mp.dir * mp.totalSteps)
-                     : _positions[j];
+    out = {};
+    if (j < CONFIG_JOINT_COUNT)
+        readConsistent([&]
+                       { out = _stats[j]; });
 }
 
-float StepperManager::getCurrentVelocity(size_t j) const
+void StepperManager::clearStepStats()
 {
-    if (_motions[j].active)
-        return _motions[j].currentV;
-    if (_jogActive[j])
-        return _jogCurrentV[j];
-    return 0;
+    noInterrupts();
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        _stats[j] = {};
+    interrupts();
 }
 
-float StepperManager::getCurrentAccel(size_t j) const
+void StepperManager::setChordStepping(bool on)
 {
-    const auto &mp = _motions[j];
-    if (mp.active)
-    {
-        if (mp.elapsed < mp.tAccel)
-            return mp.aMax;
-        else if (mp.elapsed < mp.tAccel + mp.tCruise)
-            return 0;
-        else if (mp.elapsed < mp.tTotal)
-            return -mp.aMax;
-        else
-            return 0;
-    }
-    if (_jogActive[j])
-        return _jogAccel[j];
-    return 0;
+    noInterrupts();
+    _chords = on;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        _lanes[j].nextReady = false;
+    _coordLane.nextReady = false;
+    interrupts();
 }
 
-void StepperManager::isrTrampoline()
+void StepperManager::getIsrStats(IsrStats &out, bool reset)
 {
-    if (_inst)
-        _inst->isrHandler();
+    noInterrupts();
+    out = _isrProfile.stats();
+    if (reset)
+        _isrProfile.reset();
+    interrupts();
 }
 
-void StepperManager::isrHandler()
+// ——— Move queue ————————————————————————————————————————————————
+
+bool StepperManager::queueMotion(size_t joint,
+                                 int64_t targetSteps,
+                                 float vStepsPerSec,
+                                 float aStepsPerSec2,
+                                 float jStepsPerSec3,
+                                 uint32_t id)
 {
-    // clear previous pulse highs
-    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    if (joint >= CONFIG_JOINT_COUNT || _tickHz <= 0)
+        return false;
+    takeStage(); // a commit in flight would drop what we queue
+    uint8_t mode = _axis.mode[joint];
+    if (mode == AxisJog || mode == AxisCoord)
+        return false;
+
+    auto &q = _queue[joint];
+    uint8_t tail = q.tail;
+    uint8_t next = uint8_t((tail + 1) % MOVE_QUEUE_DEPTH);
+    if (next == q.head)
+        return false; // full
+
+    // relative to where the joint will be once everything before it ran
+    int64_t from = (q.head != tail) ? q.endPos : getTargetSteps(joint);
+    long delta = long(targetSteps - from);
+    auto &qm = q.slot[tail];
+    qm.id = id;
+    if (delta == 0)
     {
-        if (_pulseHigh[j])
-        {
-            digitalWriteFast(_stepPins[j], LOW);
-            _pulseHigh[j] = false;
-        }
+        qm.motion.dir = 0;
+        qm.motion.totalSteps = 0;
     }
+    else if (!planMotion(joint, qm.motion, delta, vStepsPerSec, aStepsPerSec2, jStepsPerSec3))
+        return false;
+
+    __asm__ volatile("" ::: "memory");
+    q.tail = next;
+    q.endPos = targetSteps;
+    noInterrupts();
+    _queued |= 1UL << joint;
+    interrupts();
+    reschedule(joint);
+    return true;
+}
+
+bool StepperManager::takeFinishedMove(size_t &joint, uint32_t &id)
+{
+    uint8_t h = _finishedHead;
+    if (h == _finishedTail)
+        return false;
+    joint = _finished[h].joint;
+    id = _finished[h].id;
+    __asm__ volatile("" ::: "memory");
+    _finishedHead = uint8_t((h + 1) % FINISHED_RING);
+    return true;
+}
+
+// ISR: a full ring drops the report, never the move
+void StepperManager::reportFinished(size_t j, uint32_t id)
+{
+    if (id == 0)
+        return;
+    uint8_t t = _finishedTail;
+    uint8_t next = uint8_t((t + 1) % FINISHED_RING);
+    if (next == _finishedHead)
+        return;
+    _finished[t].joint = uint8_t(j);
+    _finished[t].id = id;
+    __asm__ volatile("" ::: "memory");
+    _finishedTail = next;
+}
 
+// ISR: last step of a move emitted
+void StepperManager::finishMove(size_t j)
+{
+    uint32_t bit = 1UL << j;
+    _axis.mode[j] = AxisIdle;
+    if (_tailOpen & bit)
+        reportFinished(j, _tailId[j]);
+    _tailing &= ~bit;
+    _tailOpen &= ~bit;
+    reportFinished(j, _moveId[j]);
+    _moveId[j] = 0;
+}
+
+// ISR (or loop with interrupts off): the joint takes some other command
+void StepperManager::dropQueue(size_t j)
+{
+    uint32_t bit = 1UL << j;
+    _queue[j].head = _queue[j].tail;
+    _queued &= ~bit;
+    _tailing &= ~bit;
+    _tailOpen &= ~bit;
+    _moveId[j] = 0;
+}
+
+// ISR, top of the tick: report blend tails that ran out and start the
+// queued moves that are due. Returns the joints that got a new plan.
+uint32_t StepperManager::serviceQueues()
+{
+    uint32_t changed = 0;
+    uint32_t vt = feedTickAt(_now);
     for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
     {
-        float v = 0;
-        int dir = 0;
-        bool runMotion = false;
+        uint32_t bit = 1UL << j;
+        uint32_t k = vt - _axis.t0[j];
+        if ((_tailOpen & bit) && k >= _tail[j].endTick())
+        {
+            reportFinished(j, _tailId[j]);
+            _tailOpen &= ~bit;
+        }
+        if (!(_queued & bit))
+            continue;
+        auto &q = _queue[j];
+        if (q.head == q.tail)
+        {
+            _queued &= ~bit;
+            continue;
+        }
+        const auto &next = q.slot[q.head].motion;
+        if (_axis.mode[j] == AxisIdle)
+        {
+            startQueued(j, false);
+            changed |= bit;
+        }
+        else if (_axis.mode[j] == AxisMove && next.dir == _axis.dir[j] && !(_tailOpen & bit))
+        {
+            // hand over once the running move is as far into its braking
+            // as the next one's ramp is long
+            const auto &cur = _motions[j].profile;
+            uint32_t m = std::min(cur.rampTicks(), next.profile.rampTicks());
+            if (k >= cur.totalTicks() - m)
+            {
+                startQueued(j, true);
+                changed |= bit;
+            }
+        }
+    }
+    return changed;
+}
 
+// ISR: pop the head of joint j's queue and run it. Blending keeps the
+// running move as the tail: its remaining steps, and any carried ones,
+// are still owed on top of the new move's.
+void StepperManager::startQueued(size_t j, bool blend)
+{
+    uint32_t bit = 1UL << j;
+    auto &q = _queue[j];
+    const QueuedMove &qm = q.slot[q.head];
+    if (qm.motion.totalSteps == 0)
+    {
+        reportFinished(j, qm.id);
+    }
+    else
+    {
+        long owed = 0;
+        uint32_t vt = feedTickAt(_now);
+        if (blend)
+        {
+            // the old tail has run out by now; its part stays a constant
+            uint32_t k = vt - _axis.t0[j];
+            uint64_t bias = (_tailing & bit) ? _tail[j].positionAt(k) : 0;
+            auto &tl = _tail[j];
+            tl.profile = _motions[j].profile;
+            tl.offset = k;
+            tl.endQ = uint64_t(_motions[j].totalSteps) << Q32_SHIFT;
+            tl.fromQ = (uint64_t(_axis.done[j]) << Q32_SHIFT) - bias;
+            _tailId[j] = _moveId[j];
+            owed = _axis.total[j] - _axis.done[j];
+            _tailing |= bit;
+            _tailOpen |= bit;
+        }
         auto &mp = _motions[j];
-        if (mp.active)
-        {
-            mp.elapsed += _dtSec;
-            if (mp.elapsed < mp.tAccel)
-                v = mp.aMax * mp.elapsed;
-            else if (mp.elapsed < mp.tAccel + mp.tCruise)
-                v = mp.vMax;
-            else if (mp.elapsed < mp.tTotal)
+        mp = qm.motion;
+        mp.startPos = _positions[j];
+        _moveId[j] = qm.id;
+        _axis.mode[j] = AxisMove;
+        _axis.dir[j] = int8_t(mp.dir);
+        // a fresh move's tick 0 is the tick the previous one ended on
+        _axis.t0[j] = blend ? vt : vt - 1;
+        _axis.done[j] = 0;
+        _axis.total[j] = mp.totalSteps + owed;
+        if (!blend)
+            _axis.carry[j] = 0;
+        newPlan(_lanes[j]);
+        turnTo(j, mp.dir);
+    }
+    q.head = uint8_t((q.head + 1) % MOVE_QUEUE_DEPTH);
+    if (q.head == q.tail)
+        _queued &= ~bit;
+}
+
+// Event scheduler: when serviceQueues next has something to do for j
+uint32_t StepperManager::queueWake(size_t j) const
+{
+    uint32_t bit = 1UL << j;
+    uint32_t k = feedTickAt(_now) - _axis.t0[j];
+    if (_tailOpen & bit)
+    {
+        uint32_t end = _tail[j].endTick();
+        return feedWake(uint64_t(_axis.t0[j] + (end > k ? end : k + 1)) << Q32_SHIFT);
+    }
+    const auto &q = _queue[j];
+    if (!(_queued & bit) || q.head == q.tail)
+        return TICK_NEVER;
+    if (_axis.mode[j] == AxisIdle)
+        return _now + 1;
+    const auto &next = q.slot[q.head].motion;
+    if (_axis.mode[j] != AxisMove || next.dir != _axis.dir[j])
+        return TICK_NEVER; // runs out first, then starts from idle
+    const auto &cur = _motions[j].profile;
+    uint32_t at = cur.totalTicks() - std::min(cur.rampTicks(), next.profile.rampTicks());
+    return feedWake(uint64_t(_axis.t0[j] + (at > k ? at : k + 1)) << Q32_SHIFT);
+}
+
+// ——— Blended path ——————————————————————————————————————————————
+
+bool StepperManager::loadPath(uint32_t epoch, uint32_t first, const PathBlock *blocks, size_t count)
+{
+    if (_tickHz <= 0 || count == 0 || count >= PATH_CAPACITY)
+        return false;
+
+    // plan off to the side; only the copy runs with the ISR masked
+    for (size_t i = 0; i < count; ++i)
+    {
+        const PathBlock &b = blocks[i];
+        PathSlot &ps = _pathLoad[i];
+        ps.masterSteps = 0;
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            ps.delta[j] = std::labs(b.delta[j]);
+            ps.dir[j] = int8_t(b.delta[j] >= 0 ? +1 : -1);
+            ps.masterSteps = std::max(ps.masterSteps, ps.delta[j]);
+        }
+        ps.id = b.id;
+        if (ps.masterSteps == 0)
+            continue;
+        if (!ps.profile.plan(uint32_t(ps.masterSteps), b.vEntry / _tickHz, b.vExit / _tickHz,
+                             b.vMax / _tickHz, b.aMax / (_tickHz * _tickHz)))
+            return false;
+        float vPeak = float(ps.profile.vPeak) * _tickHz;
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            if (ps.delta[j] && vPeak * float(ps.delta[j]) / float(ps.masterSteps) > maxStepRate(j))
+                ++_stats[j].fastPlans;
+    }
+
+    noInterrupts();
+    // the block being stepped keeps its slot
+    uint32_t oldest = (_coord.active && _coord.path) ? _pathNext - 1 : uint32_t(_pathNext);
+    bool ok = epoch == _pathEpoch && int32_t(first - _pathNext) >= 0 &&
+              int32_t(_pathEnd - first) >= 0 && first + count - oldest <= PATH_CAPACITY;
+    if (ok)
+    {
+        for (size_t i = 0; i < count; ++i)
+            _path[(first + i) % PATH_CAPACITY] = _pathLoad[i];
+        __asm__ volatile("" ::: "memory");
+        _pathEnd = first + count;
+    }
+    interrupts();
+    return ok;
+}
+
+void StepperManager::startPath()
+{
+    if (_tickHz <= 0 || _pathNext == _pathEnd || !jointsIdle())
+        return;
+    stage().path = true;
+    commit();
+}
+
+void StepperManager::pathProgress(uint32_t &epoch, uint32_t &next, bool &running) const
+{
+    readConsistent([&]
+                   {
+                       epoch = _pathEpoch;
+                       next = _pathNext;
+                       running = _coord.active && _coord.path;
+                   });
+}
+
+// ISR: step the next loaded path block from tick t0 (its tick 0), or end
+// the path when there is none. Joints that sat out the previous block
+// join in; reversing ones do so from a standstill (the look-ahead joins
+// them at zero speed) after the driver's dir setup.
+void StepperManager::startPathBlock(uint32_t t0)
+{
+    auto &cp = _coord;
+    while (_pathNext != _pathEnd)
+    {
+        const PathSlot &b = _path[_pathNext % PATH_CAPACITY];
+        _pathNext = _pathNext + 1;
+        if (b.masterSteps == 0)
+        {
+            reportFinished(FINISHED_PATH, b.id);
+            continue;
+        }
+
+        cp.path = &b;
+        cp.masterSteps = b.masterSteps;
+        cp.masterDone = 0;
+        cp.vMax = float(b.profile.vPeak) * _tickHz;
+        cp.aMax = float(fmax(fabs(b.profile.aUp), fabs(b.profile.aDown))) * _tickHz * _tickHz;
+        cp.t0 = t0;
+        cp.minStepTicks = 1;
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            cp.delta[j] = b.delta[j];
+            cp.dir[j] = b.dir[j];
+            cp.err[j] = b.masterSteps / 2;
+            cp.startPos[j] = _positions[j];
+            if (b.delta[j] == 0)
             {
-                float td = mp.elapsed - (mp.tAccel + mp.tCruise);
-                v = mp.vMax - mp.aMax * td;
-                if (v < 0)
-                    v = 0;
+                if (_axis.mode[j] == AxisCoord)
+                    _axis.mode[j] = AxisIdle;
+                continue;
             }
-            else
+            if (_axis.mode[j] != AxisCoord)
             {
-                mp.active = false;
-                continue;
+                dropQueue(j);
+                _axis.mode[j] = AxisCoord;
             }
-            if (v > mp.vMax)
-                v = mp.vMax;
-            dir = mp.dir;
-            mp.currentV = v;
-            runMotion = true;
+            turnTo(j, b.dir[j]);
+            cp.minStepTicks = std::max(cp.minStepTicks, _minStepTicks[j]);
+            if (!gateOpen(_axis.gate[j]))
+                holdGate(_coordGate, _axis.gate[j] - _now);
+        }
+        cp.active = true;
+        newPlan(_coordLane);
+        return;
+    }
+    endCoordinated();
+}
+
+// ISR (or loop with interrupts off): forget every block not started yet.
+// A block being stepped is ended by the caller.
+void StepperManager::dropPath()
+{
+    _pathNext = _pathEnd;
+    _pathEpoch = _pathEpoch + 1;
+}
+
+// ——— Consistent reads ——————————————————————————————————————————
+// The ISR bumps _seq to odd before it touches motion state and back to even
+// when done. A reader copies what it needs and retries if _seq moved, so
+// it never masks the step interrupt and never sees a half-updated tick.
+
+template <typename Read>
+void StepperManager::readConsistent(Read &&read) const
+{
+    for (;;)
+    {
+        uint32_t seq = _seq;
+        if (seq & 1)
+            continue;
+        __asm__ volatile("" ::: "memory");
+        read();
+        __asm__ volatile("" ::: "memory");
+        if (_seq == seq)
+            return;
+    }
+}
+
+void StepperManager::snapshot(Snapshot &out) const
+{
+    readConsistent([&]
+                   {
+                       uint32_t tick = currentTick();
+                       out.tick = tick;
+                       for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+                       {
+                           auto &js = out.joint[j];
+                           js.position = _positions[j];
+                           js.target = targetOf(j);
+                           js.velocity = velocityOf(j, tick);
+                           js.accel = accelOf(j, tick);
+                       }
+                   });
+}
+
+int64_t StepperManager::getPosition(size_t j) const
+{
+    int64_t p = 0;
+    if (j < CONFIG_JOINT_COUNT)
+        readConsistent([&]
+                       { p = _positions[j]; });
+    return p;
+}
+
+int64_t StepperManager::getTargetSteps(size_t j) const
+{
+    int64_t t = 0;
+    readConsistent([&]
+                   { t = targetOf(j); });
+    return t;
+}
+
+float StepperManager::getCurrentVelocity(size_t j) const
+{
+    float v = 0;
+    readConsistent([&]
+                   { v = velocityOf(j, currentTick()); });
+    return v;
+}
+
+float StepperManager::getCurrentAccel(size_t j) const
+{
+    float a = 0;
+    readConsistent([&]
+                   { a = accelOf(j, currentTick()); });
+    return a;
+}
+
+// The *Of helpers read live state: call them inside readConsistent
+int64_t StepperManager::targetOf(size_t j) const
+{
+    const auto &mp = _motions[j];
+    switch (_axis.mode[j])
+    {
+    case AxisMove:
+        return mp.startPos + mp.dir * _axis.total[j];
+    case AxisCoord:
+        return _coord.startPos[j] + _coord.dir[j] * _coord.delta[j];
+    default:
+        return _positions[j];
+    }
+}
+
+float StepperManager::velocityOf(size_t j, uint32_t tick) const
+{
+    int32_t k = int32_t(tick - _axis.t0[j]);
+    uint32_t vt = feedTickAt(tick);
+    float hz = _tickHz * _feedRate; // feed ticks per second
+    switch (_axis.mode[j])
+    {
+    case AxisMove:
+        k = int32_t(vt - _axis.t0[j]);
+        if (_tailing & (1UL << j))
+            return (_motions[j].profile.velocityAt(k) +
+                    _tail[j].profile.velocityAt(_tail[j].offset + k)) * hz;
+        return _motions[j].profile.velocityAt(k) * hz;
+    case AxisJog:
+        return k < 0 ? 0.0f : _axis.dir[j] * float(_jogRamp[j].velocityAt(k)) * _tickHz;
+    case AxisCoord:
+    {
+        const auto &cp = _coord;
+        int32_t n = int32_t(vt - cp.t0);
+        float v = !cp.path ? cp.profile.velocityAt(n) : (n < 0 ? 0.0f : float(cp.path->profile.velocityAt(n)));
+        return v * hz * float(cp.delta[j]) / float(cp.masterSteps);
+    }
+    default:
+        return 0;
+    }
+}
+
+float StepperManager::accelOf(size_t j, uint32_t tick) const
+{
+    int32_t k = int32_t(tick - _axis.t0[j]);
+    uint32_t vt = feedTickAt(tick);
+    float hz = _tickHz * _feedRate;
+    switch (_axis.mode[j])
+    {
+    case AxisMove:
+        k = int32_t(vt - _axis.t0[j]);
+        if (_tailing & (1UL << j))
+            return (_motions[j].profile.accelAt(k) +
+                    _tail[j].profile.accelAt(_tail[j].offset + k)) * hz * hz;
+        return _motions[j].profile.accelAt(k) * hz * hz;
+    case AxisJog:
+        return k < 0 ? 0.0f : _axis.dir[j] * float(_jogRamp[j].accelAt(k)) * _tickHz * _tickHz;
+    case AxisCoord:
+    {
+        const auto &cp = _coord;
+        int32_t n = int32_t(vt - cp.t0);
+        float a = !cp.path ? cp.profile.accelAt(n) : (n < 0 ? 0.0f : float(cp.path->profile.accelAt(n)));
+        return a * hz * hz * float(cp.delta[j]) / float(cp.masterSteps);
+    }
+    default:
+        return 0;
+    }
+}
+
+void StepperManager::isrTrampoline()
+{
+    if (_inst)
+        _inst->isrHandler();
+}
+
+void StepperManager::isrHandler()
+{
+    uint32_t c0 = CycleClock::now();
+    ++_seq;
+    ++_now;
+    if (_highJoints)
+        clearPulses(_now);
+    if (_stagePending >= 0)
+        applyStage();
+    if (_queued | _tailOpen)
+        serviceQueues();
+    stepCoordinated();
+    stepAxes(std::make_index_sequence<CONFIG_JOINT_COUNT>());
+    bool plan = _plannerPeriod && --_plannerCountdown == 0;
+    if (plan && _shaping)
+        sampleShapers();
+    if (_shaping)
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            stepShaped(j);
+    if (_takingUp)
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            stepTakeUp(j);
+    flushSteps();
+    if (plan)
+    {
+        if (feedDue())
+            rampFeed(); // from the next tick on, which the planner samples
+        _plannerCountdown = _plannerPeriod;
+        _plannerTick = _now;
+        _planLen = _plannerPeriod;
+        _replan = false;
+        NVIC_SET_PENDING(IRQ_SOFTWARE);
+    }
+    else if (_replan && _plannerPeriod)
+    {
+        // chords for the changed lanes up to the next planner tick
+        _plannerTick = _now;
+        _planLen = _plannerCountdown;
+        _replan = false;
+        NVIC_SET_PENDING(IRQ_SOFTWARE);
+    }
+    ++_seq;
+    _isrProfile.record(c0, CycleClock::now());
+}
+
+// ——— Planner (polled mode) ————————————————————————————————————
+
+void StepperManager::plannerTrampoline()
+{
+    if (_inst)
+        _inst->plannerHandler();
+}
+
+// Runs right after the step tick that pended it, preempted by later ones.
+// First the jog checks, in either scheduler. Polled, on the planner tick
+// it then publishes for every active lane the segment
+// covering the period that starts with the next tick; pended between them
+// it publishes, up to the next planner tick, only for lanes whose plan
+// changed. If this runs late the ISR joins the segment part way. A plan
+// swapped in by the ISR meanwhile bumps the lane's generation and the
+// stale segment is never picked up.
+void StepperManager::plannerHandler()
+{
+    checkJogs();
+    if (!_plannerPeriod)
+        return; // event mode: no chords
+    noInterrupts();
+    uint32_t first = _plannerTick + 1;
+    uint32_t len = _planLen;
+    interrupts();
+    uint32_t t0 = first - 1;
+    bool all = len == _plannerPeriod;
+    if (!_chords)
+        return;
+
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        auto &ln = _lanes[j];
+        uint32_t gen = ln.gen;
+        __asm__ volatile("" ::: "memory");
+        if (!all && ln.plannedGen == gen)
+            continue;
+        uint32_t base = _axis.t0[j];
+        if (_axis.mode[j] == AxisMove)
+        {
+            planSegment(ln, gen, first, len, _axis.total[j], [&](uint32_t t)
+                        { return feedPosition(feedClock(t), base, [&](uint32_t k)
+                                              { return movePosition(j, k); }); });
+        }
+        else if (_axis.mode[j] == AxisJog && int32_t(t0 - base) >= 0)
+        {
+            const auto &ramp = _jogRamp[j];
+            planSegment(ln, gen, first, len, LONG_MAX, [&](uint32_t t)
+                        { return ramp.positionAt(t - base); });
+        }
+    }
+
+    uint32_t gen = _coordLane.gen;
+    __asm__ volatile("" ::: "memory");
+    const auto &cp = _coord;
+    if ((all || _coordLane.plannedGen != gen) && cp.active && int32_t(feedTickAt(t0) - cp.t0) >= 0)
+        planSegment(_coordLane, gen, first, len, cp.masterSteps, [&](uint32_t t)
+                    { return coordAt(t); });
+}
+
+// The chord of `exact` over ticks first .. first + len - 1. One that would
+// reach endSteps is cut short on the tick the profile itself gets there;
+// braking, the chord runs below the profile, so that stays the final
+// step's exact tick (checked, else left to the closed form).
+template <typename Exact>
+void StepperManager::planSegment(Lane &ln, uint32_t gen, uint32_t first, uint32_t len, long endSteps,
+                                 Exact &&exact)
+{
+    ln.nextReady = false;
+    ln.plannedGen = gen;
+    uint64_t s0 = exact(first - 1);
+    uint64_t s1 = exact(first - 1 + len);
+    if (long(s1 >> Q32_SHIFT) >= endSteps)
+    {
+        uint32_t lo = 1, hi = len;
+        while (lo < hi)
+        {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (long(exact(first - 1 + mid) >> Q32_SHIFT) >= endSteps)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        len = lo;
+        s1 = exact(first - 1 + len);
+    }
+    uint64_t d = s1 >= s0 ? s1 - s0 : 0;
+    uint64_t incQ = d / len;
+    uint32_t rem = uint32_t(d % len);
+    if (long((s0 + d - incQ - (rem ? 1 : 0)) >> Q32_SHIFT) >= endSteps)
+        return;
+
+    __asm__ volatile("" ::: "memory");
+    ln.next.gen = gen;
+    ln.next.first = first;
+    ln.next.len = len;
+    ln.next.startQ = s0;
+    ln.next.incQ = incQ;
+    ln.next.rem = rem;
+    __asm__ volatile("" ::: "memory");
+    ln.nextReady = true;
+}
+
+// Profile position (Q32) at _now: one add along the published segment, or
+// the closed form when there is none for this tick yet (plan just changed,
+// planner not through yet).
+template <typename Exact>
+uint64_t StepperManager::lanePosition(Lane &ln, Exact &&exact)
+{
+    uint32_t now = _now;
+    if (!ln.live || now != ln.at + 1)
+    {
+        const Segment &sg = ln.next;
+        uint32_t k = now - sg.first;
+        if (!ln.nextReady || sg.gen != ln.gen || k >= sg.len)
+        {
+            ln.live = false;
+            return exact();
+        }
+        ln.posQ = sg.startQ + sg.incQ * k + uint64_t(sg.rem) * k / sg.len;
+        ln.incQ = sg.incQ;
+        ln.rem = sg.rem;
+        ln.len = sg.len;
+        ln.err = sg.rem * k % sg.len;
+        ln.last = sg.first + sg.len - 1;
+        ln.nextReady = false;
+        ln.live = true;
+    }
+    ln.at = now;
+    ln.posQ += ln.incQ;
+    ln.err += ln.rem;
+    if (ln.err >= ln.len)
+    {
+        ln.err -= ln.len;
+        ++ln.posQ;
+    }
+    if (now == ln.last)
+        ln.live = false;
+    return ln.posQ;
+}
+
+// Drop every step pin whose high time is over by tick `at`, one DR_CLEAR
+// store per port, and note when the next remaining one is due to fall.
+void StepperManager::clearPulses(uint32_t at)
+{
+    uint32_t drop[CONFIG_JOINT_COUNT] = {0};
+    bool first = true;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        uint32_t bit = 1UL << j;
+        if (!(_highJoints & bit))
+            continue;
+        if (int32_t(at - _pulseEnd[j]) >= 0)
+        {
+            drop[_stepPort.slot[j]] |= _stepPort.mask[j];
+            _highJoints &= ~bit;
+        }
+        else if (first || int32_t(_pulseEnd[j] - _pulseClearTick) < 0)
+        {
+            _pulseClearTick = _pulseEnd[j];
+            first = false;
+        }
+    }
+    _stepPort.clear(drop);
+}
+
+// Raise every edge collected this tick: one DR_SET store per port, so all
+// joints on a port step on the same clock edge.
+void StepperManager::flushSteps()
+{
+    if (!_raisedJoints)
+        return;
+    _stepPort.set(_stepRaise);
+    for (size_t p = 0; p < _stepPort.ports; ++p)
+        _stepRaise[p] = 0;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        if (!(_raisedJoints & (1UL << j)))
+            continue;
+        _pulseEnd[j] = _now + _pulseTicks[j];
+        if (!_highJoints || int32_t(_pulseEnd[j] - _pulseClearTick) < 0)
+            _pulseClearTick = _pulseEnd[j];
+        _highJoints |= 1UL << j;
+    }
+    _raisedJoints = 0;
+}
+
+void StepperManager::writeDir(size_t j, int dir)
+{
+    _dirOut[j] = dir;
+    bool fin = (dir > 0) ^ _isReversed[j];
+    uint32_t mask = _dirPort.mask[j];
+    StepPinIO::write(fin ? _dirPort.setReg[_dirPort.slot[j]]
+                         : _dirPort.clearReg[_dirPort.slot[j]],
+                     mask);
+}
+
+// ISR: joint j's command sets off in `dir`. Turn the pin (the driver's dir
+// setup holds the next edge) and cross any play; a shaped joint's pin
+// turns when its shaper gets there instead.
+void StepperManager::turnTo(size_t j, int dir)
+{
+    if (_shaped & (1UL << j))
+        return;
+    if (dir != _dirOut[j])
+    {
+        writeDir(j, dir);
+        holdGate(_axis.gate[j], _dirSetupTicks[j]);
+    }
+    armTakeUp(j);
+}
+
+bool StepperManager::stepCoordinated()
+{
+    auto &cp = _coord;
+    if (!cp.active)
+        return false;
+    if (cp.masterDone == cp.masterSteps)
+    {
+        // path block finished last tick (its last edge is out): next one
+        startPathBlock(cp.t0 + cp.path->profile.nTotal);
+        if (!cp.active)
+            return false;
+    }
+    if (int32_t(feedTickAt(_now) - cp.t0) < 0)
+        return false; // a path block ahead of its time base
+
+    uint64_t sQ = lanePosition(_coordLane, [&]
+                               { return coordAt(_now); });
+    long due = long(sQ >> Q32_SHIFT);
+    if (due > cp.masterSteps)
+        due = cp.masterSteps;
+    bool go = takeEdge(_coordGate, cp.minStepTicks, _coordCarry, due - cp.masterDone);
+    if (_coordCarry > 0)
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            if (cp.delta[j] != 0)
+                noteCarry(j, _coordCarry);
+    if (!go)
+        return false;
+
+    // Bresenham: each master step advances every member by delta/L, so a
+    // member never steps faster than the master
+    bool raised = false;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        if (cp.delta[j] == 0)
+            continue;
+        cp.err[j] += cp.delta[j];
+        if (cp.err[j] >= cp.masterSteps)
+        {
+            cp.err[j] -= cp.masterSteps;
+            commandStep(j);
+            _positions[j] += cp.dir[j];
+            _axis.gate[j] = _now + _minStepTicks[j];
+            raised = true;
+        }
+    }
+    if (++cp.masterDone == cp.masterSteps)
+    {
+        if (cp.path)
+            reportFinished(FINISHED_PATH, cp.path->id);
+        else
+            endCoordinated();
+    }
+    return raised;
+}
+
+void StepperManager::endCoordinated()
+{
+    _coord.active = false;
+    _coord.path = nullptr;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        if (_axis.mode[j] == AxisCoord)
+            _axis.mode[j] = AxisIdle;
+}
+
+// At most one edge per `spacing` ticks: of `owed` steps due now, one goes
+// out if the gate is open and the rest is carried to the following ticks.
+bool StepperManager::takeEdge(uint32_t &gate, uint32_t spacing, long &carry, long owed)
+{
+    if (owed <= 0)
+    {
+        carry = 0;
+        return false;
+    }
+    bool go = gateOpen(gate);
+    if (go)
+        gate = _now + spacing;
+    carry = owed - (go ? 1 : 0);
+    return go;
+}
+
+// Keep the gate shut for at least `ticks` from now
+void StepperManager::holdGate(uint32_t &gate, uint32_t ticks)
+{
+    uint32_t t = _now + ticks;
+    if (gateOpen(gate) || int32_t(t - gate) > 0)
+        gate = t;
+}
+
+// One edge of backlash take-up on a tick the joint's own plan left free.
+// It holds the joint's gate (and the group's, for an unshaped coordinated
+// member) like any other edge, so the plan's next step may be carried a tick.
+bool StepperManager::stepTakeUp(size_t j)
+{
+    uint32_t bit = 1UL << j;
+    if (!(_takingUp & bit))
+        return false;
+    long owed = takeUpOwed(j);
+    if (owed <= 0)
+    {
+        _takingUp &= ~bit;
+        return false;
+    }
+    bool shaped = _shaped & bit;
+    uint32_t &gate = shaped ? _shapeGate[j] : _axis.gate[j];
+    if ((_raisedJoints & bit) || !gateOpen(gate) || int32_t(_now - _takeUpAt[j]) < 0)
+        return false;
+    raiseStep(j);
+    _slack[j] += _dirOut[j];
+    gate = _now + _minStepTicks[j];
+    if (inCoordinated(j) && !shaped)
+        holdGate(_coordGate, _minStepTicks[j]);
+    _takeUpAt[j] = _now + _takeUpTicks[j];
+    if (owed == 1)
+        _takingUp &= ~bit;
+    return true;
+}
+
+// Sample every shaped joint's command into the ring (on the planner grid)
+void StepperManager::sampleShapers()
+{
+    _shapeHead = (_shapeHead + 1) % SHAPE_HISTORY;
+    _shapeAt = _now;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        if (!(_shaped & (1UL << j)))
+            continue;
+        int64_t pos = _positions[j];
+        if (pos != _shapeHist[j][(_shapeHead + SHAPE_HISTORY - 1) % SHAPE_HISTORY])
+            _shapeQuiet[j] = 0;
+        else if (_shapeQuiet[j] < SHAPE_HISTORY)
+            ++_shapeQuiet[j];
+        _shapeHist[j][_shapeHead] = pos;
+    }
+}
+
+// How far joint j's shaper has its pin ahead of where the pin is, in
+// 1 / (_shapePeriod * SHAPE_ONE) steps. It changes by `slope` a tick and
+// stays on that line for the next `steady` ticks, until a tap moves on to
+// the next pair of samples.
+int64_t StepperManager::shapedLead(size_t j, int64_t &slope, uint32_t &steady) const
+{
+    const uint32_t n = _shapePeriod;
+    const int64_t out = _shapeOut[j];
+    int64_t lead = 0;
+    slope = 0;
+    steady = n;
+    for (uint8_t i = 0; i < _shapeTaps[j]; ++i)
+    {
+        int64_t w = _shapeWeight[j][i];
+        // the tap reads the command `lag` ticks before the latest sample
+        int32_t lag = int32_t(_shapeAt + _shapeDelay[j][i] - _now);
+        if (lag < 1)
+        {
+            // a sample overdue (a late event wake-up): hold the latest
+            lead += w * (_shapeHist[j][_shapeHead] - out) * n;
+            steady = 1;
+            continue;
         }
-        else if (_jogActive[j])
+        uint32_t back = (uint32_t(lag) + n - 1) / n;
+        uint32_t phase = back * n - uint32_t(lag);
+        int64_t a = _shapeHist[j][(_shapeHead - back) % SHAPE_HISTORY] - out;
+        int64_t b = _shapeHist[j][(_shapeHead - back + 1) % SHAPE_HISTORY] - out;
+        lead += w * (a * n + (b - a) * int64_t(phase));
+        slope += w * (b - a);
+        steady = std::min(steady, n - phase);
+    }
+    return lead;
+}
+
+// One edge of a shaped joint's pin toward where its shaper has it. The dir
+// pin only turns once the last edge's low time is over. When the command
+// has held still for as long as the taps reach back and the pin is there,
+// the joint stops being shaped until its command moves again.
+bool StepperManager::stepShaped(size_t j)
+{
+    uint32_t bit = 1UL << j;
+    if (!(_shaping & bit))
+        return false;
+    int64_t slope;
+    uint32_t steady;
+    int64_t lead = shapedLead(j, slope, steady);
+    int64_t unit = int64_t(_shapePeriod) * SHAPE_ONE;
+    int want = lead >= unit ? +1 : (lead <= -unit ? -1 : 0);
+    if (want == 0)
+    {
+        if (_shapeQuiet[j] >= _shapeSpan[j] && _shapeOut[j] == _positions[j])
+            _shaping &= ~bit;
+        return false;
+    }
+    if (!gateOpen(_shapeGate[j]))
+        return false;
+    if (want != _dirOut[j])
+    {
+        writeDir(j, want);
+        holdGate(_shapeGate[j], _dirSetupTicks[j]);
+        armTakeUp(j);
+        return false;
+    }
+    armTakeUp(j);
+    raiseStep(j);
+    _shapeOut[j] += want;
+    _shapeGate[j] = _now + _minStepTicks[j];
+    return true;
+}
+
+void StepperManager::noteCarry(size_t j, long carry)
+{
+    if (carry <= 0)
+        return;
+    auto &st = _stats[j];
+    ++st.heldTicks;
+    if (uint32_t(carry) > st.peakCarry)
+        st.peakCarry = uint32_t(carry);
+}
+
+// Forced inline so each stepAxes() slot folds its constant joint index
+__attribute__((always_inline)) inline bool StepperManager::stepJoint(size_t j)
+{
+    long owed;
+    uint8_t mode = _axis.mode[j];
+    if (mode == AxisMove)
+    {
+        // whole steps due at this tick along the profile
+        uint64_t sQ = lanePosition(_lanes[j], [&]
+                                   { return moveAt(j, _now); });
+        long due = long(sQ >> Q32_SHIFT);
+        if (due > _axis.total[j])
+            due = _axis.total[j];
+        owed = due - _axis.done[j];
+    }
+    else if (mode == AxisJog)
+    {
+        if (int32_t(_now - _axis.t0[j]) < 0)
+            return false; // dir-setup wait after a reversal
+        uint32_t bit = 1UL << j;
+        if ((_landArmed & bit) && int32_t(_now - _landTick[j]) >= 0)
+            takeJogAction(j);
+        uint32_t k = _now - _axis.t0[j];
+        const auto &ramp = _jogRamp[j];
+        uint64_t s = _jogBaseQ[j] + lanePosition(_lanes[j], [&]
+                                                 { return ramp.positionAt(k); });
+        owed = long(s >> Q32_SHIFT) - _axis.done[j];
+
+        if (_jogReverse[j] && owed <= 0 && !ramp.ramping(k))
+        {
+            reverseJog(j);
+            return false;
+        }
+        // settled once every step of the exact profile is out (the
+        // planner's chord can still owe the last one)
+        if ((_landBraking & bit) && !ramp.ramping(k) &&
+            long((_jogBaseQ[j] + ramp.positionAt(k)) >> Q32_SHIFT) <= _axis.done[j])
         {
-            // slew currentV toward targetV using accel
-            float dv = _jogAccel[j] * _dtSec;
-            float v0 = _jogCurrentV[j], vt = _jogTargetV[j];
-            float v1 = (fabsf(vt - v0) <= dv) ? vt : (v0 + ((vt > v0) ? dv : -dv));
-            _jogCurrentV[j] = v1;
-            v = v1;
-            dir = _jogDir[j];
-            runMotion = (v1 > 0.0f);
+            landSettled(j);
+            return false;
         }
+        if (k >= JOG_REBASE_TICKS && !ramp.ramping(k))
+        {
+            // steps still owed stay in the base, as on a retarget
+            _jogRamp[j].rebase();
+            newPlan(_lanes[j]);
+            _jogBaseQ[j] = s - (uint64_t(_axis.done[j]) << Q32_SHIFT);
+            _axis.t0[j] = _now;
+            _axis.done[j] = 0;
+        }
+    }
+    else
+        return false; // idle, or stepped by stepCoordinated
+
+    bool go = takeEdge(_axis.gate[j], _minStepTicks[j], _axis.carry[j], owed);
+    noteCarry(j, _axis.carry[j]);
+    if (!go)
+        return false;
+
+    ++_axis.done[j];
+    if (mode == AxisMove && _axis.done[j] == _axis.total[j])
+        finishMove(j);
+    commandStep(j);
+    _positions[j] += _axis.dir[j];
+    return true;
+}
+
+// Braked to a standstill for a sign change: flip the dir pin (the last edge
+// was retired at the top of this tick) and ramp toward the pending target
+// once the driver's dir-setup time has passed.
+void StepperManager::reverseJog(size_t j)
+{
+    _jogReverse[j] = false;
+    _axis.dir[j] = -_axis.dir[j];
+    turnTo(j, _axis.dir[j]);
+    _jogRamp[j].reset();
+    _jogRamp[j].retarget(0,
+                         fabsf(_jogTargetV[j]) / _tickHz,
+                         _jogAccel[j] / (_tickHz * _tickHz),
+                         _jogJerk[j] / (double(_tickHz) * _tickHz * _tickHz));
+    _jogBaseQ[j] = 0;
+    _axis.done[j] = 0;
+    _axis.t0[j] = _now + _dirSetupTicks[j];
+    _landArmed &= ~(1UL << j);
+    newPlan(_lanes[j]);
+}
+
+// Joints whose jog the periodic check may still have to brake
+uint32_t StepperManager::watchedJogs() const
+{
+    uint32_t out = 0;
+    uint32_t watch = (_limited & ~_unguarded) | (_landing & ~_landArmed & ~_landBraking);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        if ((watch & (1UL << j)) && _axis.mode[j] == AxisJog && _jogTargetV[j] != 0)
+            out |= 1UL << j;
+    return out;
+}
 
-        if (!runMotion)
+// Copy of joint j's jog for the checks, taken with the ISR held off;
+// false if neither its landing nor its soft limits need looking at
+bool StepperManager::copyJog(size_t j, JogCopy &c) const
+{
+    uint32_t bit = 1UL << j;
+    if (_axis.mode[j] != AxisJog || (_landArmed & bit))
+        return false;
+    c.landing = (_landing & bit) && !(_landBraking & bit) && !_jogReverse[j];
+    c.guarded = (_limited & ~_unguarded & bit) && _jogTargetV[j] != 0;
+    if (!c.landing && !c.guarded)
+        return false;
+    c.gen = _lanes[j].gen;
+    c.first = _now + 1;
+    c.t0 = _axis.t0[j];
+    c.k = int32_t(c.first - c.t0) > 0 ? c.first - c.t0 : 0;
+    c.ramp = _jogRamp[j];
+    c.baseQ = _jogBaseQ[j];
+    c.dir = int8_t(_axis.dir[j]);
+    c.anchor = _positions[j] - c.dir * int64_t(_axis.done[j]);
+    c.need = c.dir * (_landAt[j] - c.anchor);
+    c.accel = _jogAccel[j];
+    c.jerk = _jogJerk[j];
+    c.brakeAccel = std::max(_jogAccel[j], _brakeAccel[j]);
+    c.limitMin = _limitMin[j];
+    c.limitMax = _limitMax[j];
+    return true;
+}
+
+// Distance (Q32, from the jog's anchor, _jogBaseQ included) at which the
+// jog comes to rest if it brakes from tick k of its ramp. retargetJog on
+// that tick plans the very same brake.
+uint64_t StepperManager::jogStopQ(const JogCopy &c, uint32_t k, float aStepsPerSec2) const
+{
+    JogProfile brake = c.ramp;
+    brake.retarget(k, 0.0,
+                   aStepsPerSec2 / (_tickHz * _tickHz),
+                   c.jerk / (double(_tickHz) * _tickHz * _tickHz));
+    return c.baseQ + c.ramp.positionAt(k) + brake.positionAt(brake.settleTick());
+}
+
+// Find the tick a landing jog has to brake on. Braking at tick n stops at
+// jogStopQ(n), which grows with n by at most the distance of a tick, so
+// the first n whose stop reaches the target lands on it exactly. Armed
+// once that tick falls within two planner periods; true if it was, or the
+// jog has to turn back at once.
+bool StepperManager::landJog(const JogCopy &c, JogAction &act) const
+{
+    if (!c.landing)
+        return false;
+    const uint64_t one = uint64_t(1) << Q32_SHIFT;
+    act.accel = c.accel;
+    act.turn = false;
+    if (c.need < 0 || jogStopQ(c, c.k, c.accel) >= (uint64_t(c.need) << Q32_SHIFT) + one)
+    {
+        // past it already, or cannot stop before it: come back at it
+        act.tick = c.first;
+        act.turn = true;
+        return true;
+    }
+    uint64_t needQ = uint64_t(c.need) << Q32_SHIFT;
+    uint32_t lo = c.k, hi = c.k + 2 * _shapePeriod;
+    if (jogStopQ(c, hi, c.accel) < needQ)
+        return false; // not before the next check
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (jogStopQ(c, mid, c.accel) >= needQ)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    // a stop a whole step on is a tick too fast for an exact landing:
+    // brake a tick sooner and creep the rest
+    if (lo > c.k && jogStopQ(c, lo, c.accel) >= needQ + one)
+        --lo;
+    act.tick = c.t0 + lo;
+    return true;
+}
+
+// Brake a guarded jog on the last tick from which it still stops inside
+// its soft limits, once that falls within two planner periods (at once if
+// it has gone by); true if armed. The whole stop, not just its last step,
+// has to be inside, with a tick in hand: a command the ISR takes is only
+// checked from the tick after, so one streamed against the limit must not
+// creep a fraction further each time.
+bool StepperManager::guardJog(const JogCopy &c, JogAction &act) const
+{
+    if (!c.guarded)
+        return false;
+    auto inside = [&](uint32_t k)
+    {
+        uint64_t sQ = jogStopQ(c, k + 1, c.brakeAccel) + Q32_FRAC_MASK;
+        int64_t stop = c.anchor + c.dir * int64_t(sQ >> Q32_SHIFT);
+        return c.dir > 0 ? stop <= c.limitMax : stop >= c.limitMin;
+    };
+    uint32_t lo = c.k, hi = c.k + 2 * _shapePeriod;
+    if (inside(hi))
+        return false;
+    if (!inside(lo))
+        hi = lo;
+    while (hi - lo > 1)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (inside(mid))
+            lo = mid;
+        else
+            hi = mid;
+    }
+    act.tick = c.t0 + lo;
+    act.accel = c.brakeAccel;
+    act.turn = false;
+    return true;
+}
+
+// Hand the ISR what a check found (ISR held off, plan unchanged since the
+// copy). Event mode wakes it for the tick, at once if that has come.
+void StepperManager::armJog(size_t j, const JogAction &act)
+{
+    uint32_t bit = 1UL << j;
+    _landTick[j] = int32_t(act.tick - _now) > 0 ? act.tick : _now + 1;
+    _armAccel[j] = act.accel;
+    _armTurn = act.turn ? (_armTurn | bit) : (_armTurn & ~bit);
+    _landArmed |= bit;
+    if (_mode != Scheduler::Event)
+        return;
+    _nextStep[j] = nextJointStep(j);
+    if (int32_t(_nextStep[j] - _armedTick) < 0)
+    {
+        _armedTick = _nextStep[j];
+        GPT1_OCR1 = _armedTick;
+        if (int32_t(_armedTick - GPT1_CNT) <= 0)
+            NVIC_SET_PENDING(IRQ_GPT1);
+    }
+}
+
+// ISR: the armed action's tick has come
+void StepperManager::takeJogAction(size_t j)
+{
+    uint32_t bit = 1UL << j;
+    if (_armTurn & bit)
+    {
+        retargetJog(j, -_axis.dir[j] * _landSpeed[j], _jogAccel[j], _jogJerk[j]);
+        return;
+    }
+    retargetJog(j, 0.0f, _armAccel[j], _jogJerk[j]);
+    if (_landing & bit)
+        _landBraking |= bit; // a landing picks up again from wherever this leaves it
+}
+
+// A landing brake has come to rest: done if on the target, else go on
+// toward it from here
+void StepperManager::landSettled(size_t j)
+{
+    uint32_t bit = 1UL << j;
+    _landBraking &= ~bit;
+    int64_t ahead = _landAt[j] - _positions[j];
+    if (ahead == 0)
+    {
+        _landing &= ~bit;
+        _axis.mode[j] = AxisIdle;
+        reportFinished(j, _landId[j]);
+        return;
+    }
+    retargetJog(j, ahead > 0 ? _landSpeed[j] : -_landSpeed[j], _jogAccel[j], _jogJerk[j]);
+}
+
+// Planner IRQ: every guarded or landing jog, after each planner tick and
+// plan change. An outcome whose jog changed plan meanwhile is dropped; the
+// change pended another run.
+void StepperManager::checkJogs()
+{
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        JogCopy c;
+        noInterrupts();
+        bool watch = copyJog(j, c);
+        interrupts();
+        JogAction act;
+        if (!watch || !(landJog(c, act) || guardJog(c, act)))
             continue;
+        noInterrupts();
+        if (_axis.mode[j] == AxisJog && _lanes[j].gen == c.gen && !(_landArmed & (1UL << j)))
+            armJog(j, act);
+        interrupts();
+    }
+}
+
+// ——— Feed clock ————————————————————————————————————————————————
+
+// First tick at which the feed clock reaches vQ, at the scale in force
+uint32_t StepperManager::feedTick(uint64_t vQ) const
+{
+    int64_t d = int64_t(vQ - _feedBaseQ);
+    if (d <= 0)
+        return _feedAt;
+    uint64_t n = (_feedQ == Q32_ONE) ? (uint64_t(d) + Q32_FRAC_MASK) >> Q32_SHIFT
+                                     : (uint64_t(d) + _feedQ - 1) / _feedQ;
+    return n < (1ULL << 31) ? _feedAt + uint32_t(n) : TICK_NEVER;
+}
+
+// ... for the event scheduler: no sooner than the next tick
+uint32_t StepperManager::feedWake(uint64_t vQ) const
+{
+    uint32_t t = feedTick(vQ);
+    return (t == TICK_NEVER || int32_t(t - _now) > 0) ? t : _now + 1;
+}
 
-        // accumulate fractional steps
-        float &acc = mp.stepAcc; // reuse per-joint accumulator
-        acc += v * _dtSec;
-        int steps = int(floorf(acc));
-        acc -= float(steps);
+// Tick at which a profile (tick 0 at feed tick t0) gets to sQ, n being its
+// first whole tick there: where the straight line from n - 1 crosses it
+template <typename Pos>
+uint32_t StepperManager::feedReach(uint32_t t0, uint32_t n, uint64_t sQ, Pos &&pos) const
+{
+    uint64_t vQ = uint64_t(t0 + n - 1) << Q32_SHIFT;
+    uint64_t s0 = pos(n - 1), s1 = pos(n);
+    if (s0 < sQ && s1 > s0)
+    {
+        double f = ceil(double(sQ - s0) / double(s1 - s0) * double(Q32_ONE));
+        vQ += f < double(Q32_ONE) ? uint64_t(f) : Q32_ONE;
+    }
+    return feedWake(vQ);
+}
 
-        if (mp.active && (mp.doneSteps + steps >= mp.totalSteps))
+// Joint j's speed and accel (signed, + speeding up) along its move or
+// coordinated block at feed tick vt, and the block's peak accel; per feed
+// tick. False when it is in neither.
+bool StepperManager::moveState(size_t j, uint32_t vt, float &v, float &a, float &peak) const
+{
+    if (_axis.mode[j] == AxisMove)
+    {
+        const auto &p = _motions[j].profile;
+        uint32_t k = vt - _axis.t0[j];
+        v = p.velocityAt(k);
+        a = p.accelAt(k);
+        peak = p.peakAccel();
+        if (_tailing & (1UL << j))
         {
-            steps = mp.totalSteps - mp.doneSteps;
-            mp.active = false;
+            const auto &tl = _tail[j];
+            v += tl.profile.velocityAt(tl.offset + k);
+            a += tl.profile.accelAt(tl.offset + k);
+            peak = std::max(peak, tl.profile.peakAccel());
         }
-        mp.doneSteps += steps;
+        return true;
+    }
+    if (_axis.mode[j] != AxisCoord)
+        return false;
+    const auto &cp = _coord;
+    int32_t n = int32_t(vt - cp.t0);
+    float r = float(cp.delta[j]) / float(cp.masterSteps);
+    if (n < 0)
+        v = a = 0;
+    else if (cp.path)
+    {
+        v = float(cp.path->profile.velocityAt(n));
+        a = float(cp.path->profile.accelAt(n));
+    }
+    else
+    {
+        v = cp.profile.velocityAt(n);
+        a = cp.profile.accelAt(n);
+    }
+    v *= r;
+    a *= r;
+    peak = cp.aMax / (_tickHz * _tickHz) * r;
+    return true;
+}
+
+// ISR, on the planner grid: re-anchor the feed clock at _now and step its
+// scale s toward the commanded one for the ticks that follow. A joint
+// moving at v (per feed tick) with accel a then feels s² * a + s' * v, so
+// s' is held to what keeps that inside its _brakeAccel, and s to where
+// s² times the planned peak accel still fits. Returns the joints retimed.
+uint32_t StepperManager::rampFeed()
+{
+    _feedBaseQ = feedClock(_now);
+    _feedAt = _now;
+    float s = _feedRate, want = _feedTarget;
+    if (s == want)
+        return 0;
 
-        while (steps-- > 0)
+    uint32_t vt = uint32_t(_feedBaseQ >> Q32_SHIFT);
+    float period = float(_shapePeriod);
+    float lo = -INFINITY, hi = INFINITY; // change over the period the joints allow
+    uint32_t moving = 0;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        float v, a, peak;
+        if (!moveState(j, vt, v, a, peak))
+            continue;
+        moving |= 1UL << j;
+        float limit = _brakeAccel[j] / (_tickHz * _tickHz);
+        if (!(limit > 0))
+            continue;
+        if (peak > 0)
+            want = fminf(want, sqrtf(limit / peak));
+        if (v > 0)
         {
-            digitalWriteFast(_stepPins[j], HIGH);
-            _pulseHigh[j] = true;
-            _positions[j] += (dir > 0 ? +1 : -1);
+            lo = fmaxf(lo, (-limit - s * s * a) / v * period);
+            hi = fminf(hi, (limit - s * s * a) / v * period);
         }
     }
+    float ds = fminf(fmaxf(want - s, lo), hi);
+    if (!(ds * (want - s) > 0))
+        return 0; // held (or capped) where it is
+    _feedRate = (ds == want - s) ? want : s + ds;
+    _feedQ = toQ32(_feedRate);
+
+    // segments already sampled at the old scale are stale
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        if (moving & (1UL << j))
+            newPlan(_lanes[j]);
+    if (_coord.active)
+        newPlan(_coordLane);
+    return moving;
+}
+
+// ——— Event scheduler ———————————————————————————————————————————
+
+uint32_t StepperManager::nextJointStep(size_t j) const
+{
+    uint8_t mode = _axis.mode[j];
+    uint32_t wake = ((_queued | _tailOpen) & (1UL << j)) ? queueWake(j) : TICK_NEVER;
+    if (_takingUp & (1UL << j))
+    {
+        // the take-up edge, or whatever the joint's own plan has sooner
+        uint32_t ready = edgeReady(pinGate(j));
+        uint32_t t = int32_t(_takeUpAt[j] - ready) > 0 ? _takeUpAt[j] : ready;
+        if (wake == TICK_NEVER || int32_t(t - wake) < 0)
+            wake = t;
+    }
+    if (_shaping & (1UL << j))
+    {
+        uint32_t t = nextShapedStep(j);
+        if (wake == TICK_NEVER || int32_t(t - wake) < 0)
+            wake = t;
+    }
+    if (mode != AxisMove && mode != AxisJog)
+        return wake;
+    if (_axis.carry[j] > 0)
+        return edgeReady(_axis.gate[j]); // owed steps drain at the full rate
+
+    uint32_t at = TICK_NEVER, t0 = _axis.t0[j], stop = TICK_NEVER;
+    if (mode == AxisMove)
+    {
+        // solved on the feed clock, then back to the tick
+        uint64_t need = uint64_t(_axis.done[j] + 1) << Q32_SHIFT;
+        uint32_t from = feedTickAt(_now) - t0;
+        uint32_t n = (_tailing & (1UL << j)) ? _tail[j].tickReaching(_motions[j].profile, need, from)
+                                             : _motions[j].profile.tickReaching(need, from);
+        if (n != TICK_NEVER)
+            at = feedReach(t0, n, need, [&](uint32_t k)
+                           { return movePosition(j, k); });
+    }
+    else
+    {
+        uint32_t from = (int32_t(_now - t0) > 0) ? _now - t0 : 0;
+        uint64_t need = uint64_t(_axis.done[j] + 1) << Q32_SHIFT;
+        uint64_t sQ = (need > _jogBaseQ[j]) ? need - _jogBaseQ[j] : 0;
+        uint32_t n = _jogRamp[j].tickReaching(sQ, from);
+        if (n != TICK_NEVER)
+            at = t0 + n;
+        if (_jogReverse[j] || (_landBraking & (1UL << j)))
+        {
+            // wake when the brake-to-zero settles so reverseJog (or
+            // landSettled) can run
+            stop = _jogRamp[j].settleTick();
+            if (stop <= from)
+                stop = from + 1;
+        }
+        else if (_landArmed & (1UL << j))
+            stop = _landTick[j] - t0; // the armed brake (or turn) is taken
+    }
+    uint32_t t = TICK_NEVER;
+    if (at != TICK_NEVER)
+    {
+        uint32_t ready = edgeReady(_axis.gate[j]);
+        t = int32_t(at - ready) < 0 ? ready : at;
+    }
+    // the reversal (or landing) wake-up is not an edge, so it is not gated
+    if (stop != TICK_NEVER && (t == TICK_NEVER || int32_t(t0 + stop - t) < 0))
+        t = t0 + stop;
+    // nor is a queued hand-over
+    if (wake != TICK_NEVER && (t == TICK_NEVER || int32_t(wake - t) < 0))
+        t = wake;
+    return t;
+}
+
+// The tick the shaped pin of joint j next has an edge (or a dir change)
+// due, or the end of the straight stretch the shaper is on, whichever
+// comes first
+uint32_t StepperManager::nextShapedStep(size_t j) const
+{
+    int64_t slope;
+    uint32_t steady;
+    int64_t lead = shapedLead(j, slope, steady);
+    int64_t unit = int64_t(_shapePeriod) * SHAPE_ONE;
+    if (lead >= unit || lead <= -unit)
+        return edgeReady(_shapeGate[j]);
+    if (_shapeQuiet[j] >= _shapeSpan[j] && _shapeOut[j] == _positions[j])
+        return _now + 1; // caught up: let stepShaped retire it
+    if (slope != 0)
+    {
+        int64_t rate = slope > 0 ? slope : -slope;
+        int64_t gap = slope > 0 ? unit - lead : unit + lead;
+        int64_t n = (gap + rate - 1) / rate;
+        if (n <= int64_t(steady))
+        {
+            uint32_t t = _now + uint32_t(n);
+            uint32_t ready = edgeReady(_shapeGate[j]);
+            return int32_t(t - ready) < 0 ? ready : t;
+        }
+    }
+    return _now + steady;
+}
+
+uint32_t StepperManager::nextCoordStep() const
+{
+    const auto &cp = _coord;
+    if (!cp.active)
+        return TICK_NEVER;
+    if (cp.masterDone == cp.masterSteps)
+        return _now + 1; // switch to the next path block
+    uint32_t ready = edgeReady(_coordGate);
+    if (_coordCarry > 0)
+        return ready;
+    uint32_t vt = feedTickAt(_now);
+    uint32_t from = int32_t(vt - cp.t0) > 0 ? vt - cp.t0 : 0;
+    uint64_t need = uint64_t(cp.masterDone + 1) << Q32_SHIFT;
+    uint32_t n = cp.path ? cp.path->profile.tickReaching(need, from) : cp.profile.tickReaching(need, from);
+    if (n == TICK_NEVER)
+        return TICK_NEVER;
+    uint32_t t = feedReach(cp.t0, n, need, [&](uint32_t k)
+                           { return coordPosition(k); });
+    return int32_t(t - ready) < 0 ? ready : t;
+}
+
+// Loop-context plan change: recompute that joint's next edge (evaluated as
+// of the live counter) and pull the compare in if it is now the soonest.
+void StepperManager::reschedule(size_t j)
+{
+    if (_mode != Scheduler::Event)
+        return;
+
+    noInterrupts();
+    uint32_t cnt = GPT1_CNT;
+    uint32_t saved = _now;
+    _now = cnt;
+    uint32_t t = nextJointStep(j);
+    _now = saved;
+    if (t != TICK_NEVER && int32_t(t - cnt) <= 0)
+        t = cnt + 1;
+    _nextStep[j] = t;
+    if (t != TICK_NEVER && int32_t(t - _armedTick) < 0)
+    {
+        _armedTick = t;
+        GPT1_OCR1 = t;
+        if (int32_t(t - GPT1_CNT) <= 0)
+            NVIC_SET_PENDING(IRQ_GPT1);
+    }
+    interrupts();
+}
+
+void StepperManager::rescheduleAll()
+{
+    if (_mode != Scheduler::Event)
+        return;
+
+    noInterrupts();
+    uint32_t cnt = GPT1_CNT;
+    uint32_t saved = _now;
+    _now = cnt;
+    uint32_t t = nextCoordStep();
+    _coordNext = (t != TICK_NEVER && int32_t(t - cnt) <= 0) ? cnt + 1 : t;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        t = nextJointStep(j);
+        _nextStep[j] = (t != TICK_NEVER && int32_t(t - cnt) <= 0) ? cnt + 1 : t;
+    }
+    _now = saved;
+    armEarliest(cnt);
+    if (int32_t(_armedTick - GPT1_CNT) <= 0)
+        NVIC_SET_PENDING(IRQ_GPT1);
+    interrupts();
+}
+
+// Arm OCR1 for the soonest pending edge after `after`; an idle machine still
+// wakes every EVENT_MAX_GAP_TICKS so held jogs get re-anchored.
+void StepperManager::armEarliest(uint32_t after)
+{
+    uint32_t best = after + EVENT_MAX_GAP_TICKS;
+    auto consider = [&](uint32_t t)
+    {
+        if (t != TICK_NEVER && int32_t(t - after) > 0 && int32_t(t - best) < 0)
+            best = t;
+    };
+    consider(_coordNext);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        consider(_nextStep[j]);
+    if (_shaping)
+    {
+        // the next sample of the shaped commands, at once if it is overdue
+        uint32_t t = _shapeAt + _shapePeriod;
+        consider(int32_t(t - after) > 0 ? t : after + 1);
+    }
+    if (watchedJogs())
+    {
+        uint32_t t = _checkAt + _shapePeriod;
+        consider(int32_t(t - after) > 0 ? t : after + 1);
+    }
+    if (_feedRate != _feedTarget)
+    {
+        uint32_t t = _feedAt + _shapePeriod;
+        consider(int32_t(t - after) > 0 ? t : after + 1);
+    }
+    _armedTick = best;
+    GPT1_OCR1 = best;
+}
+
+void StepperManager::gptTrampoline()
+{
+    if (_inst)
+        _inst->eventIsrHandler();
+}
+
+void StepperManager::eventIsrHandler()
+{
+    uint32_t c0 = CycleClock::now();
+    GPT1_SR = GPT_SR_OF1 | GPT_SR_OF2; // timing is re-derived from CNT below
+
+    if (_highJoints && int32_t(_pulseClearTick - GPT1_CNT) <= 0)
+    {
+        clearPulses(GPT1_CNT);
+        if (_highJoints)
+            GPT1_OCR2 = _pulseClearTick;
+    }
+
+    // Loop so a compare that slipped into the past while we were busy is
+    // serviced now rather than after a full counter wrap.
+    ++_seq;
+    bool check = false;
+    while (int32_t(_armedTick - GPT1_CNT) <= 0)
+    {
+        _now = _armedTick;
+        if (_highJoints)
+            clearPulses(_now); // falling behind: retire edges that are due first
+
+        bool any = false;
+        uint32_t changed = 0;
+        if (_stagePending >= 0)
+        {
+            changed = applyStage();
+            any = true;
+        }
+        if (_queued | _tailOpen)
+        {
+            uint32_t started = serviceQueues();
+            changed |= started;
+            any |= (started != 0);
+        }
+        // soft limits and landings on the planner grid, as when polled
+        if (watchedJogs() && int32_t(_now - _checkAt - _shapePeriod) >= 0)
+        {
+            _checkAt = _now;
+            check = true;
+            any = true;
+        }
+        // the feed scale steps on the planner grid too
+        if (feedDue() && int32_t(_now - _feedAt - _shapePeriod) >= 0)
+        {
+            uint32_t retimed = rampFeed();
+            changed |= retimed;
+            any |= (retimed != 0); // a re-anchor alone leaves the heartbeat due
+        }
+        if (_coordNext == _now)
+        {
+            uint32_t takingUp = _takingUp, shaping = _shaping;
+            stepCoordinated();
+            // a path block set a joint off the other way, or a shaped one off at all
+            changed |= (_takingUp & ~takingUp) | (_shaping & ~shaping);
+            _coordNext = nextCoordStep();
+            any = true;
+        }
+        // a freshly committed axis is evaluated at its commit tick too
+        uint32_t due = changed;
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            if (_nextStep[j] == _now)
+                due |= 1UL << j;
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            if (due & (1UL << j))
+                stepJoint(j);
+        // shaped pins follow the commands as of this tick, as when polled
+        if (_shaping && int32_t(_now - _shapeAt - _shapePeriod) >= 0)
+        {
+            sampleShapers();
+            any = true;
+        }
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            if (!(due & (1UL << j)))
+                continue;
+            stepShaped(j);
+            stepTakeUp(j);
+            _nextStep[j] = nextJointStep(j);
+            any = true;
+        }
+        if (changed)
+            _coordNext = nextCoordStep();
+        if (!any)
+        {
+            // heartbeat: let long jog holds re-anchor, nothing is due
+            for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            {
+                stepJoint(j);
+                _nextStep[j] = nextJointStep(j);
+            }
+        }
+
+        flushSteps();
+        if (_highJoints)
+            GPT1_OCR2 = _pulseClearTick;
+        armEarliest(_now);
+    }
+    if (_highJoints && int32_t(_pulseClearTick - GPT1_CNT) <= 0)
+        NVIC_SET_PENDING(IRQ_GPT1); // a fall came due while we were busy
+    // the planner IRQ runs the jog checks, on the grid and after a change
+    if (check || (_replan && watchedJogs()))
+        NVIC_SET_PENDING(IRQ_SOFTWARE);
+    _replan = false;
+    ++_seq;
+    _isrProfile.record(c0, CycleClock::now());
+#ifdef ARDUINO
+    asm volatile("dsb"); // the status clear lands before the return
+#endif
 }
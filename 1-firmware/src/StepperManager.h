@@ -3,92 +3,785 @@
 
 #include <Arduino.h>
 #include <IntervalTimer.h>
+#include <utility>
 #include "Config.h"
 #include "PinDef.h"
+#include "MotionProfile.h"
+#include "StepPinIO.h"
+#include "IsrProfiler.h"
+
+// Joint sets are tracked as 32-bit masks in the ISR
+static_assert(CONFIG_JOINT_COUNT <= 32, "at most 32 joints");
 
 class StepperManager
 {
 public:
+    enum class Scheduler : uint8_t
+    {
+        Polled, // IntervalTimer fires every tick and visits every joint
+        Event   // GPT1 compare is armed only for the soonest pending step
+    };
+
     static StepperManager &instance();
 
-    void begin(uint32_t freqHz);
+    // freqHz is the tick rate: the ISR rate when polled, the timing
+    // resolution of step edges when event-driven. The event scheduler
+    // evaluates every profile exactly; polled mode follows the same
+    // profiles through a 1 kHz planner (see Lane below), exact at each
+    // planner tick and linear in between.
+    void begin(uint32_t freqHz, Scheduler mode = Scheduler::Polled);
     void end();
 
-    // One-off trapezoidal position move
+    // — Staged multi-axis commit ——
+    // Build any mix of axis plans off to the side, then commit(): the ISR
+    // swaps them all in at the start of one tick, so the axes start together
+    // and never read a half-written plan. Planning happens in the stage*
+    // calls; the start*/setJog* calls below are stage + commit of one axis.
+    bool stageMotion(size_t joint,
+                     long deltaSteps,
+                     float vStepsPerSec,
+                     float aStepsPerSec2,
+                     float jStepsPerSec3 = 0);
+    bool stageCoordinated(const long deltaSteps[CONFIG_JOINT_COUNT],
+                          const float vStepsPerSec[CONFIG_JOINT_COUNT],
+                          const float aStepsPerSec2[CONFIG_JOINT_COUNT],
+                          const float jStepsPerSec3[CONFIG_JOINT_COUNT] = nullptr,
+                          float durationSec = 0);
+    bool stageJog(size_t joint,
+                  int dir,
+                  float vStepsPerSec,
+                  float aStepsPerSec2,
+                  float jStepsPerSec3 = 0,
+                  bool guarded = true);
+    void stageJogTarget(size_t joint,
+                        float vStepsPerSec,
+                        float aStepsPerSec2,
+                        float jStepsPerSec3 = 0,
+                        bool guarded = true);
+    void stageJogTo(size_t joint,
+                    int64_t targetSteps,
+                    float vStepsPerSec,
+                    float aStepsPerSec2,
+                    float jStepsPerSec3,
+                    uint32_t id);
+    bool commit();
+    void stageDiscard();
+
+    // One-off position move: jerk-limited S-curve when jStepsPerSec3 > 0,
+    // plain trapezoid otherwise
     bool startMotion(size_t joint,
                      long deltaSteps,
                      float vStepsPerSec,
-                     float aStepsPerSec2);
+                     float aStepsPerSec2,
+                     float jStepsPerSec3 = 0);
+
+    // Queued position move to an absolute target, tagged with a non-zero
+    // id (0 = untagged). Up to MOVE_QUEUE_DEPTH wait per joint; each starts
+    // on the tick the one before it finishes, and one continuing in the
+    // same direction takes over while the other brakes, so the joint does
+    // not stop in between. False if the queue is full or the joint is
+    // jogging or in a coordinated move. Any other command for the joint,
+    // and emergencyStop, drop what is queued.
+    static constexpr size_t MOVE_QUEUE_DEPTH = 8;
+    bool queueMotion(size_t joint,
+                     int64_t targetSteps,
+                     float vStepsPerSec,
+                     float aStepsPerSec2,
+                     float jStepsPerSec3,
+                     uint32_t id);
+    // Next finished queued move (its joint and id); false when none
+    bool takeFinishedMove(size_t &joint, uint32_t &id);
+
+    // Coordinated move: one master trapezoid drives every joint with a
+    // non-zero delta; steps are distributed Bresenham-style so all of them
+    // start and finish on the same tick (straight line in joint space).
+    // Per-joint limits are honoured by scaling the master profile.
+    // durationSec > 0 stretches the master in time to end that long after
+    // the start; false if the limits cannot make it that fast.
+    bool startCoordinated(const long deltaSteps[CONFIG_JOINT_COUNT],
+                          const float vStepsPerSec[CONFIG_JOINT_COUNT],
+                          const float aStepsPerSec2[CONFIG_JOINT_COUNT],
+                          const float jStepsPerSec3[CONFIG_JOINT_COUNT] = nullptr,
+                          float durationSec = 0);
+
+    // — Blended path ——
+    // Straight joint-space blocks run back to back on the coordinated
+    // master, each entered and left at the speed the loop-side look-ahead
+    // (PathPlanner) gave it, so the arm passes through its waypoints
+    // without stopping. Blocks are numbered in order; the ISR starts them
+    // one after another, and any block it has not started yet may be
+    // reloaded with new join speeds. A block takes its joints over from
+    // whatever else they were doing; any other command for a joint of the
+    // running block, and emergencyStop, drop the whole path.
+    static constexpr size_t PATH_CAPACITY = 32;
+    static constexpr size_t FINISHED_PATH = 0xFF; // takeFinishedMove joint of a path block
+    struct PathBlock
+    {
+        long delta[CONFIG_JOINT_COUNT]; // steps, signed
+        float vMax;                     // master steps/s
+        float aMax;                     // master steps/s²
+        float vEntry;                   // master steps/s at the start ...
+        float vExit;                    // ... and at the end
+        uint32_t id;                    // reported when the block is done, 0 = untagged
+    };
+    // Replace blocks first.. with `count` new ones, the last ending at
+    // rest. False if the ISR has started block `first`, the path was
+    // dropped since `epoch`, or they do not fit.
+    bool loadPath(uint32_t epoch, uint32_t first, const PathBlock *blocks, size_t count);
+    // Run the loaded blocks from rest once every joint is still
+    void startPath();
+    // epoch changes whenever the path is dropped; next is the first block
+    // not started, running while one is being stepped
+    void pathProgress(uint32_t &epoch, uint32_t &next, bool &running) const;
 
     // Continuous jog API (mode is kept alive until emergencyStop)
+    // jStepsPerSec3 > 0 slews with bounded jerk (continuous acceleration
+    // across retargets), 0 keeps the linear ramp
     bool startJog(size_t joint,
                   int dir,
                   float vStepsPerSec,
-                  float aStepsPerSec2);
+                  float aStepsPerSec2,
+                  float jStepsPerSec3 = 0,
+                  bool guarded = true);
     void stopJog(size_t joint);
 
-    // NEW: update jog targets without restarting the jog profile
+    // NEW: update jog targets without restarting the jog profile.
+    // Velocities are signed; a sign change decelerates through zero.
     void setJogTarget(size_t joint,
                       float vStepsPerSec,
-                      float aStepsPerSec2);
+                      float aStepsPerSec2,
+                      float jStepsPerSec3 = 0,
+                      bool guarded = true);
     void setJogTargetsAll(const float vStepsPerSec[CONFIG_JOINT_COUNT],
-                          const float aStepsPerSec2[CONFIG_JOINT_COUNT]);
+                          const float aStepsPerSec2[CONFIG_JOINT_COUNT],
+                          const float jStepsPerSec3[CONFIG_JOINT_COUNT] = nullptr);
+
+    // Jog toward targetSteps at up to vStepsPerSec, then brake onto it: the
+    // brake starts on the tick from which it ends exactly there (found on
+    // every jog command and planner period, like the soft-limit check).
+    // Heading away, or too fast to stop in time, it turns round first; one
+    // that stops short creeps the rest. On arrival the joint falls idle and
+    // a non-zero id is reported through takeFinishedMove. The target is
+    // held inside the soft limits.
+    void jogTo(size_t joint,
+               int64_t targetSteps,
+               float vStepsPerSec,
+               float aStepsPerSec2,
+               float jStepsPerSec3,
+               uint32_t id);
 
     // Smoothly command all axes toward 0 speed
-    void setAllJogTargetsZero(float aStepsPerSec2);
+    void setAllJogTargetsZero(float aStepsPerSec2, float jStepsPerSec3 = 0);
 
     // Kill everything immediately
     void emergencyStop();
 
     bool isIdle() const;
 
-    void resetPosition(size_t joint, long position);
-    long getPosition(size_t joint) const;
+    void resetPosition(size_t joint, int64_t position);
+    int64_t getPosition(size_t joint) const;
 
-    long getTargetSteps(size_t j) const;
+    int64_t getTargetSteps(size_t j) const;
     float getCurrentVelocity(size_t j) const;
     float getCurrentAccel(size_t j) const;
 
+    struct JointSnapshot
+    {
+        int64_t position; // steps
+        int64_t target;   // steps
+        float velocity;   // steps/s (signed while jogging)
+        float accel;      // steps/s²
+    };
+    struct Snapshot
+    {
+        uint32_t tick; // ISR tick the values belong to
+        JointSnapshot joint[CONFIG_JOINT_COUNT];
+    };
+
+    // Every joint at the same tick, read without masking the step ISR
+    void snapshot(Snapshot &out) const;
+
+    // Driver timing per joint: step high time (the low time before the
+    // next edge is held to the same width) and dir setup before an edge.
+    // Rounded up to whole ticks; may be called before or after begin().
+    void setStepTiming(size_t joint, float pulseUs, float dirSetupUs);
+
+    // Play in a joint's drive train (steps). Whenever the joint sets off
+    // against the way it last went, the play is crossed with extra edges
+    // in the new direction, no faster than takeUpStepsPerSec and alongside
+    // whatever it runs; they never count toward its position. A changed
+    // amount assumes the drive sits against the side it last moved to.
+    void setBacklash(size_t joint, long steps, float takeUpStepsPerSec);
+
+    // Input shaping: the joint's pin follows its commanded position run
+    // through the shaper's impulses, one planner period (1 ms) late, so the
+    // motor trails the command by up to the shaper's duration plus that
+    // period. Position, velocity and target report the command; isIdle()
+    // waits for the motor too. False if the joint is busy (moving, queued,
+    // or still catching up) or the shaper is longer than MAX_SHAPER_SEC.
+    static constexpr float MAX_SHAPER_SEC = 0.5f;
+    bool setShaper(size_t joint, const InputShaper &shaper);
+
+    // Soft travel limits for jogs (steps). At every jog command and every
+    // planner period, a jog that could no longer stop inside them if it ran
+    // on until the next check brakes to zero at its own accel (at least
+    // brakeStepsPerSec2) and jerk. Jogs commanded with guarded = false run
+    // past them (homing). minSteps > maxSteps turns them off.
+    void setSoftLimits(size_t joint, int64_t minSteps, int64_t maxSteps, float brakeStepsPerSec2);
+
+    // Feed override: moves, coordinated moves and path blocks follow their
+    // profiles on a feed clock that gains `scale` ticks per tick, so they
+    // keep their paths and only run faster or slower (speeds by scale,
+    // accels by scale²). A new scale is slewed to once per planner period,
+    // and each joint in motion holds it to what its brakeStepsPerSec2 has
+    // room for: the change adds scale' * speed to its accel. The scale is
+    // also capped where its planned peak accel, scaled, would exceed that
+    // limit. Jogs run in real time. False unless 0 < scale <= FEED_OVERRIDE_MAX.
+    static constexpr float FEED_OVERRIDE_MAX = 2.0f;
+    bool setFeedOverride(float scale);
+    float feedOverride() const; // as commanded
+
+    // Fastest rate a joint can be stepped (steps/s) under its timing. Steps
+    // a profile asks for beyond that are carried over to the next free
+    // tick, never dropped, and counted here.
+    float maxStepRate(size_t joint) const;
+    struct StepStats
+    {
+        uint32_t heldTicks; // ticks on which a due edge was carried over
+        uint32_t peakCarry; // most steps owed at once
+        uint32_t fastPlans; // plans whose peak rate exceeded maxStepRate()
+    };
+    void getStepStats(size_t joint, StepStats &out) const;
+    void clearStepStats();
+
+    // Step ISR execution time against the tick period since begin() or
+    // the last reset (polled or event handler, whichever is running)
+    void getIsrStats(IsrStats &out, bool reset);
+
+    // Polled mode: have the ISR evaluate every profile's closed form on
+    // every tick (the default), or step along the planner's chords. Both
+    // land every step. Chords stay opt-in until test/embedded/test_isr_bench
+    // shows them cheaper on the Teensy; on the host they are not.
+    void setChordStepping(bool on);
+
 private:
     StepperManager();
     static void isrTrampoline();
     void isrHandler();
+    static void gptTrampoline();
+    void eventIsrHandler();
+    static void plannerTrampoline();
+    void plannerHandler();
+
+    // Shared step core: emit whatever is due at _now on one joint / the
+    // coordinated group. Returns true if a pulse was raised.
+    bool stepJoint(size_t j);
+    bool stepCoordinated();
+    bool takeEdge(uint32_t &gate, uint32_t spacing, long &carry, long owed);
+    void noteCarry(size_t j, long carry);
+    void holdGate(uint32_t &gate, uint32_t ticks);
 
-    bool _pulseHigh[CONFIG_JOINT_COUNT] = {false};
+    // Edge gates: the earliest tick a line may step again. A pending gate is
+    // never more than _gateSpan ticks ahead, so an old one reads as open.
+    inline bool gateOpen(uint32_t gate) const { return uint32_t(gate - _now - 1) >= _gateSpan; }
+    inline uint32_t edgeReady(uint32_t gate) const { return gateOpen(gate) ? _now + 1 : gate; }
+    void clearPulses(uint32_t at);
+    void flushSteps();
+    void writeDir(size_t j, int dir);
+    void turnTo(size_t j, int dir);
+    bool stepTakeUp(size_t j);
+
+    // Step/dir pins resolved to GPIO ports at begin(): every step edge of a
+    // tick is collected per port and raised/dropped with one store per port.
+    StepPortMap<CONFIG_JOINT_COUNT> _stepPort;
+    StepPortMap<CONFIG_JOINT_COUNT> _dirPort;
+    uint32_t _stepRaise[CONFIG_JOINT_COUNT] = {0}; // edges collected this tick, per port slot
+    uint32_t _raisedJoints = 0;                    // joints in _stepRaise (bit per joint)
+    uint32_t _highJoints = 0;                      // step pins currently high (bit per joint)
+    uint32_t _pulseEnd[CONFIG_JOINT_COUNT] = {0};  // tick each high pin may fall
+
+    inline void raiseStep(size_t j)
+    {
+        _stepRaise[_stepPort.slot[j]] |= _stepPort.mask[j];
+        _raisedJoints |= 1UL << j;
+    }
+    // A step of the commanded motion: out on the pin, or for a shaped
+    // joint only into the position its shaper follows
+    inline void commandStep(size_t j)
+    {
+        uint32_t bit = 1UL << j;
+        if (!(_shaped & bit))
+        {
+            raiseStep(j);
+            return;
+        }
+        if (!_shaping)
+        {
+            // sampling stopped while nothing moved: back onto its grid
+            _shapeAt = _now - 1 - (_now - 1 - _shapeAt) % _shapePeriod;
+        }
+        _shaping |= bit;
+    }
 
     IntervalTimer _timer;
     uint8_t _stepPins[CONFIG_JOINT_COUNT];
     uint8_t _dirPins[CONFIG_JOINT_COUNT];
     bool _isReversed[CONFIG_JOINT_COUNT];
-    volatile long _positions[CONFIG_JOINT_COUNT];
+    volatile int64_t _positions[CONFIG_JOINT_COUNT];
+
+    // Seqlock: odd while the ISR (or resetPosition) is updating motion state
+    volatile uint32_t _seq = 0;
+    template <typename Read>
+    void readConsistent(Read &&read) const;
+    int64_t targetOf(size_t j) const;
+    float velocityOf(size_t j, uint32_t tick) const;
+    float accelOf(size_t j, uint32_t tick) const;
+
+    // — Per-axis hot state ——
+    // What stepJoint touches every tick, one array per field so the
+    // unrolled axis loop indexes each with a constant. A joint is in
+    // exactly one mode, which picks the profile it follows; progress along
+    // it is kept here. The instance is a static, so on the Teensy all of
+    // it sits in DTCM next to the ITCM-resident ISR.
+    enum AxisMode : uint8_t
+    {
+        AxisIdle,
+        AxisMove, // _motions[j]
+        AxisJog,  // _jogRamp[j]
+        AxisCoord // member of _coord, stepped by stepCoordinated
+    };
+    struct AxisHot
+    {
+        uint8_t mode[CONFIG_JOINT_COUNT];
+        int8_t dir[CONFIG_JOINT_COUNT];    // step direction of the move/jog
+        uint32_t t0[CONFIG_JOINT_COUNT];   // tick at which profile tick 0 starts (feed tick for a move)
+        long done[CONFIG_JOINT_COUNT];     // steps emitted since t0
+        long total[CONFIG_JOINT_COUNT];    // move length (steps)
+        uint32_t gate[CONFIG_JOINT_COUNT]; // earliest tick of the next edge
+        long carry[CONFIG_JOINT_COUNT];    // steps due but not yet emitted
+    } _axis = {};
+
+    // stepJoint over every axis, unrolled at compile time (polled ISR)
+    template <size_t... J>
+    inline void stepAxes(std::index_sequence<J...>) { (stepJoint(J), ...); }
 
     struct MotionPlan
     {
-        bool active = false;
-        size_t joint = 0;
         int dir = +1;
         long totalSteps = 0;
-        long doneSteps = 0;
-        long startPos = 0;
+        int64_t startPos = 0;
+        float vMax = 0; // steps/s actually planned (reporting only)
+        float aMax = 0; // steps/s² actually planned (reporting only)
+        MoveProfile profile;
+    } _motions[CONFIG_JOINT_COUNT];
+    bool planMotion(size_t joint, MotionPlan &mp, long deltaSteps,
+                    float vStepsPerSec, float aStepsPerSec2, float jStepsPerSec3);
+
+    // Profile distance of joint j's move at its tick k, blend tail included
+    inline uint64_t movePosition(size_t j, uint32_t k) const
+    {
+        uint64_t s = _motions[j].profile.positionAt(k);
+        if (_tailing & (1UL << j))
+            s += _tail[j].positionAt(k);
+        return s;
+    }
+
+    // — Move queue ——
+    // Filled by the loop (tail), drained by the ISR (head). A blended
+    // hand-over keeps the move taken over from as _tail[j]; _axis.total
+    // then counts the steps both still owe.
+    struct QueuedMove
+    {
+        MotionPlan motion; // totalSteps 0: nothing to move, report only
+        uint32_t id;
+    };
+    struct MoveQueue
+    {
+        QueuedMove slot[MOVE_QUEUE_DEPTH];
+        volatile uint8_t head = 0;
+        volatile uint8_t tail = 0;
+        int64_t endPos = 0; // loop only: where the last queued move ends
+    } _queue[CONFIG_JOINT_COUNT];
+    volatile uint32_t _queued = 0; // joints with queued moves (set by the loop, cleared by the ISR)
+    BlendTail _tail[CONFIG_JOINT_COUNT];
+    uint32_t _tailId[CONFIG_JOINT_COUNT] = {0};
+    uint32_t _tailing = 0;  // _tail[j] is part of the move's position
+    uint32_t _tailOpen = 0; // ... and has not reached its end yet
+    uint32_t _moveId[CONFIG_JOINT_COUNT] = {0};
+
+    struct FinishedMove
+    {
+        uint8_t joint;
+        uint32_t id;
+    };
+    static constexpr size_t FINISHED_RING = 16;
+    FinishedMove _finished[FINISHED_RING];
+    volatile uint8_t _finishedHead = 0; // loop reads
+    volatile uint8_t _finishedTail = 0; // ISR writes
+
+    uint32_t serviceQueues();
+    void startQueued(size_t j, bool blend);
+    void finishMove(size_t j);
+    void dropQueue(size_t j);
+    void reportFinished(size_t j, uint32_t id);
+    uint32_t queueWake(size_t j) const;
+
+    // — Path ring ——
+    // Block n sits in slot n % PATH_CAPACITY. The loop loads blocks from
+    // _pathNext to _pathEnd; the ISR takes them in order, and the one it
+    // is stepping stays put until it is done.
+    struct PathSlot
+    {
+        long masterSteps = 0; // 0: nothing to move, report only
+        long delta[CONFIG_JOINT_COUNT] = {0}; // |steps| per joint
+        int8_t dir[CONFIG_JOINT_COUNT] = {0};
+        LinkProfile profile;
+        uint32_t id = 0;
+    };
+    PathSlot _path[PATH_CAPACITY];
+    PathSlot _pathLoad[PATH_CAPACITY]; // loop: planned here, copied in with the ISR masked
+    volatile uint32_t _pathNext = 0;
+    volatile uint32_t _pathEnd = 0;
+    volatile uint32_t _pathEpoch = 0;
+    void startPathBlock(uint32_t t0);
+    void dropPath();
+    bool jointsIdle() const; // isIdle() but for a path loaded and not started
+
+    struct CoordPlan
+    {
+        bool active = false;
+        const PathSlot *path = nullptr; // block being run, null for a one-off move
+        long masterSteps = 0; // longest axis delta: one Bresenham tick per master step
+        long masterDone = 0;
         float vMax = 0;
         float aMax = 0;
-        float tAccel = 0;
-        float tCruise = 0;
-        float tTotal = 0;
-        float elapsed = 0;
-        float stepAcc = 0;
-        float currentV = 0;
-    } _motions[CONFIG_JOINT_COUNT];
+        uint32_t t0 = 0; // feed tick
+        uint32_t minStepTicks = 1; // slowest member's edge spacing
+        MoveProfile profile;
+        long delta[CONFIG_JOINT_COUNT] = {0}; // |steps| per joint, 0 = not a member
+        long err[CONFIG_JOINT_COUNT] = {0};
+        int dir[CONFIG_JOINT_COUNT] = {0};
+        int64_t startPos[CONFIG_JOINT_COUNT] = {0};
+    } _coord;
+
+    // Master distance at tick k of _coord
+    inline uint64_t coordPosition(uint32_t k) const
+    {
+        return _coord.path ? _coord.path->profile.positionAt(k) : _coord.profile.positionAt(k);
+    }
 
-    // Jog state per joint
-    bool _jogActive[CONFIG_JOINT_COUNT] = {false};
-    int _jogDir[CONFIG_JOINT_COUNT] = {0};
+    inline bool inCoordinated(size_t j) const { return _axis.mode[j] == AxisCoord; }
+    void endCoordinated();
+
+    // Jog plan per joint
     float _jogTargetV[CONFIG_JOINT_COUNT] = {0};
     float _jogAccel[CONFIG_JOINT_COUNT] = {0};
-    float _jogCurrentV[CONFIG_JOINT_COUNT] = {0};
-    float _jogRem[CONFIG_JOINT_COUNT] = {0};
+    float _jogJerk[CONFIG_JOINT_COUNT] = {0};
+    JogProfile _jogRamp[CONFIG_JOINT_COUNT];      // from _axis.t0, the last retarget
+    uint64_t _jogBaseQ[CONFIG_JOINT_COUNT] = {0}; // distance owed from before it
+
+    bool _jogReverse[CONFIG_JOINT_COUNT] = {false}; // braking to zero before a sign change
+
+    // — Soft limits (jogs) ——
+    int64_t _limitMin[CONFIG_JOINT_COUNT] = {0};
+    int64_t _limitMax[CONFIG_JOINT_COUNT] = {0};
+    float _brakeAccel[CONFIG_JOINT_COUNT] = {0}; // steps/s², least a guarded jog brakes with; feed override limit
+    uint32_t _limited = 0;   // joints with soft limits (bit per joint)
+    uint32_t _unguarded = 0; // ... whose jog runs past them
+    uint32_t _checkAt = 0;   // event mode: tick of the last check (on the planner grid, _shapePeriod)
+    uint32_t watchedJogs() const;
+
+    // — Jog landings (jogTo) ——
+    int64_t _landAt[CONFIG_JOINT_COUNT] = {0};
+    float _landSpeed[CONFIG_JOINT_COUNT] = {0};      // steps/s
+    uint32_t _landId[CONFIG_JOINT_COUNT] = {0};
+    uint32_t _landing = 0;     // joints whose jog ends on _landAt
+    uint32_t _landBraking = 0; // ... braking for it now
+    void landSettled(size_t j);
+
+    // — Jog checks (planner IRQ) ——
+    // The searches for when a guarded or landing jog has to brake run in
+    // the planner, on a copy of the jog taken with the ISR held off, after
+    // every planner tick and plan change. What they find is armed for the
+    // ISR as one action, taken on the first step tick from _landTick on:
+    // brake to rest with _armAccel, or (_armTurn) come back at the target.
+    // Any other change to the jog's plan disarms it.
+    uint32_t _landTick[CONFIG_JOINT_COUNT] = {0};
+    float _armAccel[CONFIG_JOINT_COUNT] = {0}; // steps/s²
+    uint32_t _landArmed = 0; // joints with an action armed (bit per joint)
+    uint32_t _armTurn = 0;   // ... that turns back rather than brakes
+    struct JogCopy
+    {
+        uint32_t gen;   // lane generation it was taken at
+        uint32_t first; // first tick an action can be taken on
+        uint32_t k;     // ... as a tick of the ramp
+        uint32_t t0;
+        JogProfile ramp;
+        uint64_t baseQ;
+        int64_t need;   // steps from the ramp's anchor to the landing target
+        int64_t anchor; // position at the ramp's anchor
+        int8_t dir;
+        float accel, jerk, brakeAccel;
+        bool landing, guarded;
+        int64_t limitMin, limitMax;
+    };
+    struct JogAction
+    {
+        uint32_t tick;
+        float accel;
+        bool turn;
+    };
+    bool copyJog(size_t j, JogCopy &c) const;
+    uint64_t jogStopQ(const JogCopy &c, uint32_t k, float aStepsPerSec2) const;
+    bool landJog(const JogCopy &c, JogAction &act) const;
+    bool guardJog(const JogCopy &c, JogAction &act) const;
+    void armJog(size_t j, const JogAction &act);
+    void takeJogAction(size_t j);
+    void checkJogs();
+
+    // — Step-rate limiting (per-joint gate and carry live in _axis) ——
+    int _dirOut[CONFIG_JOINT_COUNT] = {0}; // direction last written to the pin
+
+    // — Backlash take-up ——
+    // _slack is where the motor sits in the play: 0 against the − side,
+    // _backlash against the + side. What is left to cross follows from the
+    // dir pin, so a reversal part way through just turns the take-up back.
+    long _backlash[CONFIG_JOINT_COUNT] = {0};
+    long _slack[CONFIG_JOINT_COUNT] = {0};
+    float _takeUpRate[CONFIG_JOINT_COUNT] = {0};    // steps/s, 0 = as fast as the driver allows
+    uint32_t _takeUpTicks[CONFIG_JOINT_COUNT];      // spacing of take-up edges
+    uint32_t _takeUpAt[CONFIG_JOINT_COUNT] = {0};   // earliest tick of the next one
+    uint32_t _takingUp = 0;                         // joints crossing their play (bit per joint)
+    inline long takeUpOwed(size_t j) const { return _dirOut[j] > 0 ? _backlash[j] - _slack[j] : _slack[j]; }
+    // ISR: a joint sets off; cross whatever play lies ahead of it
+    inline void armTakeUp(size_t j)
+    {
+        uint32_t bit = 1UL << j;
+        if (!(_takingUp & bit) && takeUpOwed(j) > 0)
+        {
+            _takingUp |= bit;
+            _takeUpAt[j] = _now;
+        }
+    }
+
+    // — Input shaping ——
+    // Every planner period the commanded position of each shaped joint is
+    // sampled into a ring; its pin follows the sum of the shaper's taps,
+    // each reading the ring (interpolated) its delay back. Between samples
+    // that sum is linear in the tick, so the event scheduler can solve for
+    // the next edge. Units of the sum: 1 / (_shapePeriod * SHAPE_ONE) step.
+    static constexpr size_t SHAPE_HISTORY = 512; // samples: MAX_SHAPER_SEC at 1 kHz and then some
+    static constexpr int64_t SHAPE_ONE = 1 << 16; // tap weights sum to this
+    InputShaper _shaper[CONFIG_JOINT_COUNT];
+    uint32_t _shaped = 0;  // joints with a shaper (bit per joint)
+    uint32_t _shaping = 0; // ... whose pin has yet to catch up
+    uint8_t _shapeTaps[CONFIG_JOINT_COUNT] = {0};
+    int64_t _shapeWeight[CONFIG_JOINT_COUNT][InputShaper::MAX_IMPULSES];
+    uint32_t _shapeDelay[CONFIG_JOINT_COUNT][InputShaper::MAX_IMPULSES]; // ticks, one period added
+    uint32_t _shapeSpan[CONFIG_JOINT_COUNT] = {0};  // samples the last tap reaches back
+    uint16_t _shapeQuiet[CONFIG_JOINT_COUNT] = {0}; // samples since the command last moved
+    int64_t _shapeHist[CONFIG_JOINT_COUNT][SHAPE_HISTORY];
+    uint32_t _shapeHead = 0;    // slot of the latest sample ...
+    uint32_t _shapeAt = 0;      // ... and its tick
+    uint32_t _shapePeriod = 1;  // ticks between samples
+    int64_t _shapeOut[CONFIG_JOINT_COUNT] = {0};  // steps the pin has made
+    uint32_t _shapeGate[CONFIG_JOINT_COUNT] = {0}; // pin edge gate of a shaped joint
+    inline uint32_t pinGate(size_t j) const { return (_shaped & (1UL << j)) ? _shapeGate[j] : _axis.gate[j]; }
+    void updateShaper(size_t j);
+    void resetShaper(size_t j, int64_t pos);
+    void sampleShapers();
+    int64_t shapedLead(size_t j, int64_t &slope, uint32_t &steady) const;
+    bool stepShaped(size_t j);
+    uint32_t nextShapedStep(size_t j) const;
+
+    uint32_t _coordGate = 0;
+    long _coordCarry = 0;
+    StepStats _stats[CONFIG_JOINT_COUNT] = {};
+
+    void startJogNow(size_t joint, float vStepsPerSec, float aStepsPerSec2, float jStepsPerSec3);
+    void retargetJog(size_t joint, float vStepsPerSec, float aStepsPerSec2, float jStepsPerSec3);
+    void reverseJog(size_t joint);
+
+    // Holding a jog speed re-anchors the ramp before vtQ * tick can overflow
+    static constexpr uint32_t JOG_REBASE_TICKS = 1UL << 24;
+
+    // — Staged commit (double buffer) ——
+    struct StagedAxis
+    {
+        enum Kind : uint8_t
+        {
+            Keep,      // leave the axis as it is
+            Move,      // start `motion` (profile planned at stage time)
+            JogStart,  // (re)enter jog from rest
+            JogTarget, // retarget a running jog, or start one
+            JogTo      // ... and land it on landAt
+        } kind = Keep;
+        MotionPlan motion;
+        float jogV = 0; // signed steps/s
+        float jogA = 0;
+        float jogJ = 0;
+        bool guarded = true; // the jog brakes for the soft limits
+        int64_t landAt = 0;  // steps
+        uint32_t landId = 0;
+    };
+    struct StagedSet
+    {
+        StagedAxis axis[CONFIG_JOINT_COUNT];
+        bool coordinated = false;
+        CoordPlan coord;
+        bool path = false; // start the loaded path
+    };
+    StagedSet _stage[2];
+    uint8_t _stageWrite = 0;            // buffer the loop is filling
+    volatile int8_t _stagePending = -1; // buffer published to the ISR, -1 = none
+    bool _ticking = false;              // the tick source is running
+    static constexpr uint32_t STAGE_WAIT_US = 100;
+
+    StagedSet &stage();
+    void takeStage();
+    float jogSpeed(size_t joint, float vStepsPerSec);
+    bool stretchProfile(MoveProfile &p, uint32_t steps, float v, float a, float j,
+                        float durationSec) const;
+    uint32_t applyStage();
+
+    // — Time base ——
+    Scheduler _mode = Scheduler::Polled;
+    float _tickHz = 0;
+    volatile uint32_t _now = 0; // tick being processed by the ISR
+    uint32_t currentTick() const;
+    IsrProfiler _isrProfile;
+    void wakeSoon();
+
+    // — Feed clock (feed override) ——
+    // Moves, coordinated moves and path blocks count their ticks on it, in
+    // Q32 ticks: _feedBaseQ at tick _feedAt, plus _feedQ for every tick
+    // since. At scale 1 it is the tick itself. Between its whole ticks a
+    // profile is followed in a straight line.
+    volatile float _feedTarget = 1.0f; // scale commanded (loop)
+    float _feedRate = 1.0f;            // scale in force ...
+    uint64_t _feedQ = Q32_ONE;         // ... Q32
+    uint64_t _feedBaseQ = 0;
+    uint32_t _feedAt = 0; // re-anchored on the planner grid (_shapePeriod)
+    inline uint64_t feedClock(uint32_t t) const
+    {
+        return _feedBaseQ + uint64_t(int64_t(int32_t(t - _feedAt))) * _feedQ;
+    }
+    inline uint32_t feedTickAt(uint32_t t) const { return uint32_t(feedClock(t) >> Q32_SHIFT); }
+    // Slewing, or due to re-anchor before the clock's product can overflow
+    inline bool feedDue() const { return _feedRate != _feedTarget || _now - _feedAt >= JOG_REBASE_TICKS; }
+    // pos(k) of a profile whose tick 0 is feed tick t0, at feed clock vQ
+    template <typename Pos>
+    static inline uint64_t feedPosition(uint64_t vQ, uint32_t t0, Pos &&pos)
+    {
+        uint32_t k = uint32_t(vQ >> Q32_SHIFT) - t0;
+        uint64_t f = vQ & Q32_FRAC_MASK;
+        uint64_t s = pos(k);
+        if (f == 0)
+            return s;
+        uint64_t s1 = pos(k + 1);
+        uint64_t d = s1 > s ? s1 - s : 0;
+        return s + (d >> Q32_SHIFT) * f + (((d & Q32_FRAC_MASK) * f) >> Q32_SHIFT);
+    }
+    inline uint64_t moveAt(size_t j, uint32_t t) const
+    {
+        return feedPosition(feedClock(t), _axis.t0[j], [&](uint32_t k)
+                            { return movePosition(j, k); });
+    }
+    inline uint64_t coordAt(uint32_t t) const
+    {
+        return feedPosition(feedClock(t), _coord.t0, [&](uint32_t k)
+                            { return coordPosition(k); });
+    }
+    uint32_t feedTick(uint64_t vQ) const;
+    uint32_t feedWake(uint64_t vQ) const;
+    template <typename Pos>
+    uint32_t feedReach(uint32_t t0, uint32_t n, uint64_t sQ, Pos &&pos) const;
+    bool moveState(size_t j, uint32_t vt, float &v, float &a, float &peak) const;
+    uint32_t rampFeed();
+
+    // — Event scheduler (GPT1 free-running at the tick rate) ——
+    static constexpr uint32_t GPT_CLOCK_HZ = 24000000; // perclk, as used by the PIT
+    // Wake at least this often so long holds are re-anchored (see rebase)
+    static constexpr uint32_t EVENT_MAX_GAP_TICKS = JOG_REBASE_TICKS;
+
+    uint32_t _nextStep[CONFIG_JOINT_COUNT]; // absolute tick of each joint's next edge
+    uint32_t _coordNext = TICK_NEVER;
+    uint32_t _armedTick = 0;
+    uint32_t _pulseClearTick = 0; // soonest _pulseEnd while any pin is high
+
+    // — Driver timing (ticks, from the per-joint microseconds) ——
+    float _pulseUs[CONFIG_JOINT_COUNT];
+    float _dirSetupUs[CONFIG_JOINT_COUNT];
+    uint32_t _pulseTicks[CONFIG_JOINT_COUNT];
+    uint32_t _minStepTicks[CONFIG_JOINT_COUNT]; // edge spacing: pulse high + low time
+    uint32_t _dirSetupTicks[CONFIG_JOINT_COUNT];
+    uint32_t _gateSpan = 1;
+    uint32_t setupTicks(float us) const;
+    void updateTiming(size_t j);
+
+    // — Two-rate stepping (polled mode) ——
+    // Every PLANNER_HZ the planner (a software IRQ below the step ISR)
+    // samples each active profile at both ends of the planner period just
+    // starting and publishes the straight line between them. The step ISR
+    // then only accumulates phase along that line. Any plan change bumps
+    // the lane's generation and pends the planner for the rest of the
+    // period, so the ISR evaluates the closed form itself only on the tick
+    // of the change (or while the planner is held off). A move's last
+    // chord is cut short to end on its final step's exact tick. Off unless
+    // setChordStepping turns it on: the planner then only runs the jog
+    // checks.
+    static constexpr uint32_t PLANNER_HZ = 1000;
+    static constexpr uint8_t PLANNER_IRQ_PRIORITY = 208; // below the PIT
+
+    struct Segment
+    {
+        uint32_t gen;    // plan generation the samples were taken from
+        uint32_t first;  // first tick covered
+        uint32_t len;    // ticks covered
+        uint64_t startQ; // profile position at first - 1
+        uint64_t incQ;   // per-tick increment ...
+        uint32_t rem;    // ... plus rem / len, spread Bresenham-style
+    };
+    struct Lane
+    {
+        volatile uint32_t gen = 0;
+        Segment next = {};              // written by the planner only
+        volatile bool nextReady = false;
+        uint32_t plannedGen = 0;        // planner: gen of the last segment out
+        bool live = false;              // ISR is inside a segment
+        uint32_t at = 0;                // tick posQ belongs to
+        uint32_t last = 0;              // last tick of the live segment
+        uint64_t posQ = 0;
+        uint64_t incQ = 0;
+        uint32_t rem = 0;
+        uint32_t len = 1;
+        uint32_t err = 0;
+    };
+    Lane _lanes[CONFIG_JOINT_COUNT];
+    Lane _coordLane;
+    uint32_t _plannerPeriod = 0; // step ticks per planner tick, 0 = no planner
+    uint32_t _plannerCountdown = 0;
+    uint32_t _plannerTick = 0;   // step tick that triggered the pending run
+    uint32_t _planLen = 0;       // ... and the ticks it plans for
+    volatile bool _replan = false; // a lane changed plan since the last pend
+    bool _chords = false;
+
+    inline void newPlan(Lane &ln)
+    {
+        ++ln.gen;
+        ln.live = false;
+        _replan = true;
+    }
+    template <typename Exact>
+    uint64_t lanePosition(Lane &ln, Exact &&exact);
+    template <typename Exact>
+    void planSegment(Lane &ln, uint32_t gen, uint32_t first, uint32_t len, long endSteps, Exact &&exact);
 
-    float _dtSec = 0;
+    uint32_t nextJointStep(size_t j) const;
+    uint32_t nextCoordStep() const;
+    void reschedule(size_t j);
+    void rescheduleAll();
+    void armEarliest(uint32_t after);
 
     static StepperManager *_inst;
 };
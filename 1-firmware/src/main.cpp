@@ -6,6 +6,9 @@
 #include "JointManager.h"
 #include "CommManager.h"
 
+// Unity tests on the board bring their own setup()/loop()
+#ifndef PIO_UNIT_TESTING
+
 void setup()
 {
   Serial.begin(921600);
@@ -17,6 +20,7 @@ void setup()
   CalibrationManager::instance().begin();
   JointManager::instance().begin();
   // Start low‐level stepper ISR at 100 kHz
+  // (Scheduler::Event instead arms GPT1 only for the next pending step edge)
   StepperManager::instance().begin(100000);
 
   // 2) restore last-saved joint positions
@@ -47,6 +51,12 @@ void loop()
   // gating this at 20 ms would drop 49 of every 50 sub-steps.
   CommManager::instance().handleBatchExecution();
 
+  // moveDone for queued moves as soon as they finish
+  CommManager::instance().sendFinishedMoves();
+
+  // Blended path: start waiting waypoints once the look-ahead has them
+  JointManager::instance().servicePath();
+
   // ── 20 ms application tick ─────────────────────────────────────────────
   static uint32_t lastTickUs = 0;
   const uint32_t now = micros();
@@ -81,3 +91,5 @@ void loop()
   // Debounce digital inputs
   IOManager::instance().update();
 }
+
+#endif // PIO_UNIT_TESTING
@@ -0,0 +1,116 @@
+// Step ISR cost on the Teensy (pio test -e teensy41), from the DWT cycle
+// counter behind getIsrStats(): six joints busy for two seconds at
+// 100 kHz, moves finishing and restarting and a jog retargeted every
+// 400 us as batch velocity streaming does. It runs once through the ISR
+// as it was before the rework (test/reference, b97735c), then through
+// today's, stepping from every profile's closed form and along the
+// planner's chords. Run it on a bare board or with the drivers disabled:
+// the step pins toggle.
+#include <Arduino.h>
+#include <unity.h>
+#include "StepperManager.h"
+#include "../../reference/BaselineStepper.h"
+
+static constexpr uint32_t HZ = 100000;
+static constexpr uint32_t RUN_MS = 2000;
+static constexpr uint32_t RETARGET_US = 400;
+
+void setUp() {}
+void tearDown() {}
+
+// Each joint's moves swing between 0 and its reach, the next starting
+// once the last is over; joint 1 jogs
+static const long REACH[CONFIG_JOINT_COUNT] = {30000, 0, 5000, -3000, 1200, -400};
+
+// The workload on either stepper for RUN_MS, its ISR running off a timer
+template <typename Stepper>
+static void busyAxes(Stepper &sm)
+{
+    bool out[CONFIG_JOINT_COUNT] = {false};
+    uint32_t moves[CONFIG_JOINT_COUNT] = {0};
+    sm.startJog(1, +1, 8000, 20000);
+    uint32_t start = millis(), lastRetarget = micros(), n = 0;
+    while (millis() - start < RUN_MS)
+    {
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            long at = long(sm.getPosition(j));
+            if (REACH[j] && long(sm.getTargetSteps(j)) == at &&
+                sm.startMotion(j, (out[j] ? 0 : REACH[j]) - at, 40000, 60000))
+            {
+                out[j] = !out[j];
+                ++moves[j];
+            }
+        }
+        if (micros() - lastRetarget >= RETARGET_US)
+        {
+            lastRetarget += RETARGET_US;
+            sm.setJogTarget(1, 8000 + float(++n % 40) * 100, 20000);
+        }
+    }
+    sm.emergencyStop();
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        if (REACH[j])
+            TEST_ASSERT_TRUE(moves[j] >= 1);
+}
+
+static BaselineStepper baselineStepper;
+static void baselineTick() { baselineStepper.isrHandler(); }
+
+static void baseline(IsrStats &out)
+{
+    IntervalTimer timer;
+    baselineStepper.begin(HZ);
+    timer.begin(baselineTick, 1000000 / HZ);
+    busyAxes(baselineStepper);
+    timer.end();
+    baselineStepper.getIsrStats(out, false);
+}
+
+static void today(IsrStats &out, bool chords)
+{
+    auto &sm = StepperManager::instance();
+    sm.setChordStepping(chords);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        sm.resetPosition(j, 0);
+    sm.getIsrStats(out, true);
+    busyAxes(sm);
+    sm.getIsrStats(out, false);
+    sm.setChordStepping(false);
+}
+
+static void report(const char *name, const IsrStats &s)
+{
+    char msg[160];
+    snprintf(msg, sizeof msg, "%s: %lu runs, mean %lu max %lu cycles of %lu (%lu overruns)",
+             name, (unsigned long)s.count, (unsigned long)(s.totalCycles / (s.count ? s.count : 1)),
+             (unsigned long)s.maxCycles, (unsigned long)s.budget, (unsigned long)s.overruns);
+    TEST_MESSAGE(msg);
+}
+
+void test_isr_cost_six_axes()
+{
+    IsrStats before, closed, chords;
+    baseline(before);
+    StepperManager::instance().begin(HZ);
+    today(closed, false);
+    today(chords, true);
+    report("b97735c", before);
+    report("closed form", closed);
+    report("chords", chords);
+
+    TEST_ASSERT_TRUE(before.count > HZ);
+    TEST_ASSERT_TRUE(closed.count > HZ);
+    TEST_ASSERT_TRUE(chords.count > HZ);
+    TEST_ASSERT_EQUAL_UINT32(0, closed.overruns);
+}
+
+void setup()
+{
+    delay(2000); // let the test runner open the port
+    UNITY_BEGIN();
+    RUN_TEST(test_isr_cost_six_axes);
+    UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,37 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host stand-in for the parts of the Teensy core the step generator uses,
+// so the native test env can build it. Interrupt masking is a no-op: the
+// tests call the handlers themselves, one tick at a time.
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include <string.h>
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define FASTRUN
+#define DMAMEM
+
+#define F_CPU_ACTUAL 600000000u
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void digitalWriteFast(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return 0; }
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// Every read moves the clock on a microsecond, so a bounded wait for an
+// ISR the test is not running still runs out
+inline uint32_t hostMicros = 0;
+inline uint32_t micros() { return hostMicros++; }
+inline uint32_t millis() { return hostMicros / 1000; }
+inline void delay(uint32_t) {}
+inline void delayNanoseconds(uint32_t) {}
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,33 @@
+#ifndef HOST_INTERVAL_TIMER_H
+#define HOST_INTERVAL_TIMER_H
+
+#include <stdint.h>
+
+// Host IntervalTimer: nothing fires by itself. The callback begin() was
+// given is kept in hostTimerIsr for the test to call once per tick.
+inline void (*hostTimerIsr)() = nullptr;
+
+class IntervalTimer
+{
+public:
+    bool begin(void (*fn)(), uint32_t) { return attach(fn); }
+    bool begin(void (*fn)(), float) { return attach(fn); }
+    void update(float) {}
+    void priority(uint8_t) {}
+    void end()
+    {
+        if (hostTimerIsr == _fn)
+            hostTimerIsr = nullptr;
+        _fn = nullptr;
+    }
+
+private:
+    void (*_fn)() = nullptr;
+    bool attach(void (*fn)())
+    {
+        _fn = hostTimerIsr = fn;
+        return true;
+    }
+};
+
+#endif // HOST_INTERVAL_TIMER_H
@@ -0,0 +1,124 @@
+#ifndef HOST_STEP_SIM_H
+#define HOST_STEP_SIM_H
+
+#include <vector>
+#include "StepperManager.h"
+#include <imxrt.h>
+#include <IntervalTimer.h>
+
+// Runs the step generator on the host, one timer tick per tick() call:
+// the polled ISR, or GPT1's compare ISR when the tick reaches an armed
+// compare, then the planner either of them pends. Every step edge is
+// recorded with its tick.
+class StepSim
+{
+public:
+    using Scheduler = StepperManager::Scheduler;
+
+    std::vector<uint32_t> edges[CONFIG_JOINT_COUNT];
+
+    // Every store to a pin port register, when logWrites is set
+    struct PortWrite
+    {
+        uint32_t tick;
+        volatile uint32_t *reg;
+        uint32_t mask;
+    };
+    bool logWrites = false;
+    std::vector<PortWrite> writes;
+
+    // false leaves the planner IRQ pending forever: the polled ISR then
+    // steps every joint from the closed form, as the event scheduler does,
+    // and no jog is braked for its soft limits or landing
+    bool runPlanner = true;
+
+    // Fresh start at tick 0: every joint idle at position 0, with the
+    // tuning a test may have changed put back to the config defaults
+    void begin(uint32_t hz, Scheduler mode)
+    {
+        auto &sm = StepperManager::instance();
+        sm.end();
+        _mode = mode;
+        _now = 0;
+        GPT1_CNT = 0;
+        GPT1_OCR1 = GPT1_OCR2 = 0;
+        for (auto &p : hostPending)
+            p = false;
+        sm.setFeedOverride(1.0f);
+        sm.begin(hz, mode);
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            sm.resetPosition(j, 0);
+            sm.setSoftLimits(j, 1, 0, 0);
+            sm.setBacklash(j, 0, 0);
+            sm.setShaper(j, InputShaper());
+            sm.setStepTiming(j, JOINT_CONFIG[j].stepPulseUs, JOINT_CONFIG[j].dirSetupUs);
+            edges[j].clear();
+        }
+        writes.clear();
+        _active = this;
+        StepPinIO::onWrite = record;
+    }
+
+    void tick()
+    {
+        ++_now;
+        if (_mode == Scheduler::Event)
+        {
+            GPT1_CNT = _now;
+            if (GPT1_OCR1 == _now || GPT1_OCR2 == _now || hostPending[IRQ_GPT1])
+            {
+                hostPending[IRQ_GPT1] = false;
+                hostVector[IRQ_GPT1]();
+            }
+        }
+        else
+            hostTimerIsr();
+        if (runPlanner && hostPending[IRQ_SOFTWARE])
+        {
+            hostPending[IRQ_SOFTWARE] = false;
+            hostVector[IRQ_SOFTWARE]();
+        }
+    }
+
+    void run(uint32_t ticks)
+    {
+        for (uint32_t i = 0; i < ticks; ++i)
+            tick();
+    }
+
+    // Ticks until every joint is idle, at most `limit`; false on timeout
+    bool runUntilIdle(uint32_t limit)
+    {
+        auto &sm = StepperManager::instance();
+        for (uint32_t i = 0; i < limit; ++i)
+        {
+            tick();
+            if (sm.isIdle())
+                return true;
+        }
+        return false;
+    }
+
+    uint32_t now() const { return _now; }
+
+private:
+    Scheduler _mode = Scheduler::Polled;
+    uint32_t _now = 0;
+    inline static StepSim *_active = nullptr;
+
+    // A store to a step pin's set register is its rising edge
+    static void record(volatile uint32_t *reg, uint32_t mask)
+    {
+        if (_active->logWrites)
+            _active->writes.push_back({_active->_now, reg, mask});
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            uint8_t pin = JOINT_CONFIG[j].pulsePin;
+            if (reg == StepPinIO::setRegister(pin) && (mask & StepPinIO::bitMask(pin)))
+                _active->edges[j].push_back(_active->_now);
+        }
+    }
+};
+
+#endif // HOST_STEP_SIM_H
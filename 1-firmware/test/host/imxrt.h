@@ -0,0 +1,39 @@
+#ifndef HOST_IMXRT_H
+#define HOST_IMXRT_H
+
+#include <stdint.h>
+
+// Host GPT1 and NVIC: plain registers and a vector table. The test sets
+// GPT1_CNT each tick and runs the GPT1 vector when a compare matches or
+// the IRQ was pended, like the hardware would.
+enum IRQ_NUMBER_t
+{
+    IRQ_SOFTWARE = 70,
+    IRQ_GPT1 = 100,
+    HOST_IRQ_COUNT = 160
+};
+
+inline void (*hostVector[HOST_IRQ_COUNT])() = {};
+inline volatile bool hostPending[HOST_IRQ_COUNT] = {};
+
+inline void attachInterruptVector(IRQ_NUMBER_t irq, void (*fn)()) { hostVector[irq] = fn; }
+#define NVIC_SET_PENDING(n) (hostPending[n] = true)
+#define NVIC_SET_PRIORITY(n, p)
+#define NVIC_ENABLE_IRQ(n)
+#define NVIC_DISABLE_IRQ(n)
+
+inline volatile uint32_t GPT1_CR, GPT1_PR, GPT1_SR, GPT1_IR, GPT1_OCR1, GPT1_OCR2, GPT1_CNT;
+inline volatile uint32_t CCM_CCGR1;
+#define CCM_CCGR_ON 3
+#define CCM_CCGR1_GPT1_BUS(n) ((uint32_t)(((n) & 0x03) << 20))
+#define CCM_CCGR1_GPT1_SERIAL(n) ((uint32_t)(((n) & 0x03) << 22))
+#define GPT_CR_EN ((uint32_t)(1 << 0))
+#define GPT_CR_ENMOD ((uint32_t)(1 << 1))
+#define GPT_CR_CLKSRC(n) ((uint32_t)(((n) & 0x07) << 6))
+#define GPT_CR_FRR ((uint32_t)(1 << 9))
+#define GPT_IR_OF1IE ((uint32_t)(1 << 0))
+#define GPT_IR_OF2IE ((uint32_t)(1 << 1))
+#define GPT_SR_OF1 ((uint32_t)(1 << 0))
+#define GPT_SR_OF2 ((uint32_t)(1 << 1))
+
+#endif // HOST_IMXRT_H
@@ -0,0 +1,113 @@
+// Input shaping against the unshaped motion: each design's impulses sum
+// to one, so a shaped move steps to the same place, never ahead of the
+// command, and ends its duration (plus up to two planner periods) after it.
+#include <unity.h>
+#include <algorithm>
+#include <math.h>
+#include "StepSim.h"
+
+static constexpr uint32_t HZ = 100000;
+static constexpr uint32_t PLANNER_TICKS = HZ / 1000;
+
+static const ShaperType TYPES[] = {ShaperType::ZV, ShaperType::ZVD, ShaperType::EI};
+
+void setUp() {}
+void tearDown() {}
+
+void test_designs_sum_to_one()
+{
+    const float hz[] = {2.5f, 12.0f, 80.0f};
+    const float damping[] = {0.0f, 0.05f, 0.3f};
+    for (auto type : TYPES)
+        for (float f : hz)
+            for (float z : damping)
+            {
+                InputShaper s;
+                TEST_ASSERT_TRUE(s.design(type, f, z));
+                TEST_ASSERT_EQUAL_INT(type == ShaperType::ZV ? 2 : 3, s.count);
+                float sum = 0;
+                for (uint8_t i = 0; i < s.count; ++i)
+                {
+                    TEST_ASSERT_TRUE(s.amp[i] > 0);
+                    sum += s.amp[i];
+                }
+                TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, sum);
+
+                float half = 0.5f / (f * sqrtf(1 - z * z));
+                TEST_ASSERT_EQUAL_FLOAT(0.0f, s.delay[0]);
+                for (uint8_t i = 1; i < s.count; ++i)
+                    TEST_ASSERT_FLOAT_WITHIN(half * 1e-5f, half * i, s.delay[i]);
+                TEST_ASSERT_EQUAL_FLOAT(s.delay[s.count - 1], s.duration());
+            }
+
+    InputShaper s;
+    TEST_ASSERT_TRUE(s.design(ShaperType::None, 0, 0));
+    TEST_ASSERT_EQUAL_INT(0, s.count);
+    TEST_ASSERT_FALSE(s.design(ShaperType::ZV, 0, 0.1f));
+    TEST_ASSERT_FALSE(s.design(ShaperType::ZVD, 10, 1.0f));
+    TEST_ASSERT_FALSE(s.design(ShaperType::EI, 10, -0.1f));
+}
+
+// Two queued moves on one joint, to `mid` then `end`, under `shaper`
+static void runMove(StepSim &sim, StepSim::Scheduler mode, const InputShaper &shaper, int64_t mid, int64_t end)
+{
+    auto &sm = StepperManager::instance();
+    sim.begin(HZ, mode);
+    TEST_ASSERT_TRUE(sm.setShaper(2, shaper));
+    TEST_ASSERT_TRUE(sm.queueMotion(2, mid, 30000, 90000, 0, 1));
+    TEST_ASSERT_TRUE(sm.queueMotion(2, end, 20000, 60000, 0, 2));
+    TEST_ASSERT_TRUE(sim.runUntilIdle(2000000));
+    TEST_ASSERT_EQUAL_INT64(end, sm.getPosition(2));
+}
+
+// Edges made up to and including tick t
+static long edgesBy(const std::vector<uint32_t> &e, long t)
+{
+    return long(std::upper_bound(e.begin(), e.end(), uint32_t(std::max(t, 0L))) - e.begin());
+}
+
+void test_shaped_follows_unshaped()
+{
+    const StepSim::Scheduler modes[] = {StepSim::Scheduler::Polled, StepSim::Scheduler::Event};
+    for (auto mode : modes)
+    {
+        static StepSim plain;
+        // one way, so edges made so far stand for the position
+        runMove(plain, mode, InputShaper(), 12000, 20000);
+        const auto ref = plain.edges[2];
+        TEST_ASSERT_EQUAL_UINT32(20000, ref.size());
+
+        for (auto type : TYPES)
+        {
+            static StepSim shaped;
+            InputShaper s;
+            TEST_ASSERT_TRUE(s.design(type, 8.0f, 0.05f));
+            runMove(shaped, mode, s, 12000, 20000);
+            const auto &got = shaped.edges[2];
+            TEST_ASSERT_EQUAL_UINT32(ref.size(), got.size());
+
+            // the shaped pin runs no more than one step ahead of the
+            // command, nor further behind it than the shaper reaches
+            long lag = long(ceilf(s.duration() * HZ)) + 2 * PLANNER_TICKS;
+            for (long t : got)
+            {
+                TEST_ASSERT_TRUE(edgesBy(got, t) <= edgesBy(ref, t) + 1);
+                TEST_ASSERT_TRUE(edgesBy(got, t) + 1 >= edgesBy(ref, t - lag));
+            }
+            TEST_ASSERT_TRUE(got.front() >= ref.front());
+            TEST_ASSERT_TRUE(long(got.back()) <= long(ref.back()) + lag);
+            TEST_ASSERT_TRUE(long(got.back()) >= long(ref.back()) + long(s.duration() * HZ));
+
+            // turning back before the shaped pin got out there
+            runMove(shaped, mode, s, 12000, 4000);
+        }
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_designs_sum_to_one);
+    RUN_TEST(test_shaped_follows_unshaped);
+    return UNITY_END();
+}
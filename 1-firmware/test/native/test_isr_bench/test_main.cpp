@@ -0,0 +1,127 @@
+// Host benchmark of the polled step ISR: getIsrStats() with the profiler
+// clock on the host's steady clock (1 "cycle" = 1 ns, clock reads
+// included). Six joints busy at 100 kHz, each move restarting back the
+// other way once over and a jog retargeted every 40 ticks, run through
+// the ISR as it was before the rework (test/reference, b97735c) and
+// through today's, stepping from every profile's closed form and along
+// the planner's chords. Pin writes are not logged, so neither pays for
+// the simulation. The figures are printed, not asserted on: they say how
+// the three compare on this machine, not what the Teensy spends
+// (test/embedded/test_isr_bench), and the maximum takes in whatever the
+// host OS preempted the run with.
+#include <unity.h>
+#include <chrono>
+#include <stdio.h>
+#include "StepSim.h"
+#include "../../reference/BaselineStepper.h"
+
+static constexpr uint32_t HZ = 100000;
+static constexpr uint32_t TICKS = 1500000;
+
+// Each joint's moves swing between 0 and its reach, the next starting
+// once the last is over; joint 1 jogs
+static const long REACH[CONFIG_JOINT_COUNT] = {30000, 0, 5000, -3000, 1200, -400};
+
+void setUp() {}
+void tearDown() {}
+
+static uint32_t hostNanos()
+{
+    using namespace std::chrono;
+    return uint32_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+// The workload on either stepper, `tick` running its ISR once; the moves
+// each joint got through
+template <typename Stepper, typename Tick>
+static void busyAxes(Stepper &sm, Tick &&tick, uint32_t moves[CONFIG_JOINT_COUNT])
+{
+    bool out[CONFIG_JOINT_COUNT] = {false};
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        moves[j] = 0;
+    sm.startJog(1, +1, 8000, 20000);
+    for (uint32_t t = 1; t <= TICKS; ++t)
+    {
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            long at = long(sm.getPosition(j));
+            if (REACH[j] && long(sm.getTargetSteps(j)) == at &&
+                sm.startMotion(j, (out[j] ? 0 : REACH[j]) - at, 40000, 60000))
+            {
+                out[j] = !out[j];
+                ++moves[j];
+            }
+        }
+        if (t % 40 == 7)
+            sm.setJogTarget(1, 8000 + float(t / 40 % 40) * 100, 20000);
+        tick();
+    }
+    sm.emergencyStop();
+}
+
+static void checkMoves(const uint32_t moves[CONFIG_JOINT_COUNT])
+{
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        if (REACH[j])
+            TEST_ASSERT_TRUE(moves[j] >= 4);
+}
+
+static void today(IsrStats &out, bool chords)
+{
+    static StepSim sim;
+    auto &sm = StepperManager::instance();
+    sim.begin(HZ, StepSim::Scheduler::Polled);
+    StepPinIO::onWrite = nullptr;
+    sm.setChordStepping(chords);
+    sm.getIsrStats(out, true);
+    uint32_t moves[CONFIG_JOINT_COUNT];
+    busyAxes(sm, [&] { sim.tick(); }, moves);
+    sm.getIsrStats(out, false);
+    sm.setChordStepping(false);
+    checkMoves(moves);
+}
+
+static void baseline(IsrStats &out)
+{
+    static BaselineStepper sm;
+    sm.begin(HZ);
+    uint32_t moves[CONFIG_JOINT_COUNT];
+    busyAxes(sm, [&] { sm.isrHandler(); }, moves);
+    sm.getIsrStats(out, false);
+    checkMoves(moves);
+}
+
+static void report(const char *name, const IsrStats &s)
+{
+    char msg[160];
+    snprintf(msg, sizeof msg, "%s: %lu runs, mean %lu max %lu ns, %lu over the %lu ns tick",
+             name, (unsigned long)s.count, (unsigned long)(s.totalCycles / (s.count ? s.count : 1)),
+             (unsigned long)s.maxCycles, (unsigned long)s.overruns, (unsigned long)s.budget);
+    TEST_MESSAGE(msg);
+}
+
+void test_isr_cost_six_axes()
+{
+    CycleClock::rate = 1000000000;
+    CycleClock::source = hostNanos;
+    IsrStats before, closed, chords;
+    baseline(before);
+    today(closed, false);
+    today(chords, true);
+    CycleClock::source = nullptr;
+    report("b97735c", before);
+    report("closed form", closed);
+    report("chords", chords);
+
+    TEST_ASSERT_EQUAL_UINT32(TICKS, before.count);
+    TEST_ASSERT_EQUAL_UINT32(TICKS, closed.count);
+    TEST_ASSERT_EQUAL_UINT32(TICKS, chords.count);
+    TEST_ASSERT_EQUAL_UINT32(HZ ? 1000000000 / HZ : 0, chords.budget);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_isr_cost_six_axes);
+    return UNITY_END();
+}
@@ -0,0 +1,377 @@
+// Step timelines of the fixed-point move profiles over long moves: against
+// an exact tick-by-tick accumulation, the ideal continuous profile, and the
+// float generator the ISR used to run.
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "MotionProfile.h"
+
+static constexpr double HZ = 100000.0;
+
+void setUp() {}
+void tearDown() {}
+
+// Tick of every whole step of a profile, by scanning positionAt()
+template <typename Profile>
+static std::vector<uint32_t> scanSteps(const Profile &p, uint32_t steps, uint32_t ticks)
+{
+    std::vector<uint32_t> out;
+    out.reserve(steps);
+    uint64_t last = 0;
+    for (uint32_t n = 1; n <= ticks && out.size() < steps; ++n)
+    {
+        uint64_t s = p.positionAt(n);
+        TEST_ASSERT_TRUE_MESSAGE(s >= last, "position went backwards");
+        last = s;
+        while (out.size() < steps && (s >> Q32_SHIFT) > out.size())
+            out.push_back(n);
+    }
+    return out;
+}
+
+// The event scheduler's search has to land on the same ticks
+template <typename Profile>
+static void checkSearch(const Profile &p, const std::vector<uint32_t> &steps)
+{
+    uint32_t from = 0;
+    for (size_t k = 0; k < steps.size(); ++k)
+    {
+        uint32_t t = p.tickReaching(uint64_t(k + 1) << Q32_SHIFT, from);
+        TEST_ASSERT_EQUAL_UINT32(steps[k], t);
+        from = t - 1;
+    }
+}
+
+// First tick at which an ideal continuous trapezoid (accel a, cruise v,
+// steps/s units) has covered `s` steps
+static double idealTrapezoidTick(double s, double total, double v, double a, double hz = HZ)
+{
+    double tA = v / a, sA = 0.5 * a * tA * tA;
+    if (2 * sA > total)
+    {
+        tA = sqrt(total / a);
+        sA = total / 2;
+        v = a * tA;
+    }
+    double tC = (total - 2 * sA) / v;
+    double t;
+    if (s <= sA)
+        t = sqrt(2 * s / a);
+    else if (s <= total - sA)
+        t = tA + (s - sA) / v;
+    else
+        t = 2 * tA + tC - sqrt(2 * (total - s) / a);
+    return t * hz;
+}
+
+// Largest distance (ticks) of a step timeline from the continuous
+// trapezoid at the speed, accel and length (sEndQ, which runs past the
+// target by under one cruise tick) the profile was quantized to
+static double worstIdealOffset(const TrapezoidProfile &p, const std::vector<uint32_t> &steps, double hz = HZ)
+{
+    double v = ldexp(double(p.vQ), -int(Q32_SHIFT)) * hz;
+    double a = ldexp(double(p.aQ), -int(Q32_SHIFT + ACCEL_SHIFT)) * hz * hz;
+    double length = ldexp(double(p.sEndQ), -int(Q32_SHIFT));
+    double worst = 0;
+    for (size_t k = 0; k < steps.size(); ++k)
+        worst = fmax(worst, fabs(steps[k] - idealTrapezoidTick(double(k + 1), length, v, a, hz)));
+    return worst;
+}
+
+// The float generator the ISR ran before the fixed-point engine: elapsed
+// seconds and a fractional-step accumulator advanced every tick
+static std::vector<uint32_t> floatGenerator(uint32_t total, float vMax, float aMax, uint32_t ticks)
+{
+    const float dt = float(1.0 / HZ);
+    float tA = vMax / aMax, dA = 0.5f * aMax * tA * tA, tC;
+    if (total < 2 * dA)
+    {
+        vMax = sqrtf(total * aMax);
+        tA = vMax / aMax;
+        tC = 0;
+    }
+    else
+        tC = (total - 2 * dA) / vMax;
+    float tT = 2 * tA + tC, elapsed = 0, acc = 0;
+    std::vector<uint32_t> out;
+    for (uint32_t n = 1; n <= ticks && out.size() < total; ++n)
+    {
+        elapsed += dt;
+        float v;
+        if (elapsed < tA)
+            v = aMax * elapsed;
+        else if (elapsed < tA + tC)
+            v = vMax;
+        else if (elapsed < tT)
+            v = fmaxf(vMax - aMax * (elapsed - tA - tC), 0.0f);
+        else
+            break;
+        acc += v * dt;
+        int steps = int(floorf(acc));
+        acc -= float(steps);
+        while (steps-- > 0 && out.size() < total)
+            out.push_back(n);
+    }
+    return out;
+}
+
+// Ten minutes at cruise: the closed form equals the running sum of its own
+// per-tick speeds on every tick, with no drift, and lands exactly
+void test_trapezoid_exact_over_ten_minutes()
+{
+    const uint32_t total = 1800000;
+    const double v = 3000, a = 2000;
+    TrapezoidProfile p;
+    TEST_ASSERT_TRUE(p.plan(total, float(v / HZ), float(a / (HZ * HZ))));
+
+    uint64_t s = 0;
+    for (uint32_t n = 1; n <= p.nTotal; ++n)
+    {
+        s += p.velocityAt(n);
+        if (s != p.positionAt(n))
+            TEST_ASSERT_EQUAL_UINT64_MESSAGE(s, p.positionAt(n), "closed form left the running sum");
+    }
+    TEST_ASSERT_EQUAL_UINT64(p.sEndQ, s);
+    TEST_ASSERT_TRUE(p.sEndQ >= uint64_t(total) << Q32_SHIFT);
+    TEST_ASSERT_TRUE(p.sEndQ - (uint64_t(total) << Q32_SHIFT) < p.vQ);
+
+    std::vector<uint32_t> steps = scanSteps(p, total, p.nTotal);
+    TEST_ASSERT_EQUAL_UINT32(total, steps.size());
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(p.nTotal, steps.back());
+    checkSearch(p, steps);
+
+    // every step within a tick and a half of the ideal profile at the
+    // planned speed and accel, start to end
+    TEST_ASSERT_FLOAT_WITHIN(1.5, 0.0, worstIdealOffset(p, steps));
+}
+
+// A short move agrees with the float generator to a few ticks; over a long
+// one the float clock has drifted and the fixed-point timeline has not
+void test_trapezoid_matches_float_generator()
+{
+    const uint32_t total = 5000;
+    const float v = 4000, a = 8000;
+    TrapezoidProfile p;
+    TEST_ASSERT_TRUE(p.plan(total, float(v / HZ), float(a / (HZ * HZ))));
+    std::vector<uint32_t> fixed = scanSteps(p, total, p.nTotal);
+    std::vector<uint32_t> old = floatGenerator(total, v, a, 2 * p.nTotal);
+    TEST_ASSERT_EQUAL_UINT32(total, fixed.size());
+    // the float clock runs out a few steps short of the target, and its
+    // rounding wanders by a few ticks; compare up to the decel ramp, where
+    // the last steps are too slow to pin down to a tick
+    TEST_ASSERT_TRUE(old.size() > total - 20);
+    const size_t beforeDecel = total - size_t(p.sAccelQ >> Q32_SHIFT);
+    for (size_t k = 0; k < beforeDecel; ++k)
+        TEST_ASSERT_INT_WITHIN(10, old[k], fixed[k]);
+
+    const uint32_t longTotal = 600000; // 200 s at 3000 steps/s
+    TEST_ASSERT_TRUE(p.plan(longTotal, float(3000 / HZ), float(2000 / (HZ * HZ))));
+    fixed = scanSteps(p, longTotal, p.nTotal);
+    old = floatGenerator(longTotal, 3000, 2000, 2 * p.nTotal);
+    double fixedWorst = worstIdealOffset(p, fixed);
+    double floatWorst = 0;
+    for (size_t k = 0; k < old.size(); ++k)
+        floatWorst = fmax(floatWorst, fabs(old[k] - idealTrapezoidTick(double(k + 1), longTotal, 3000, 2000)));
+    char msg[96];
+    snprintf(msg, sizeof(msg), "200 s move: fixed %.1f ticks off ideal, float %.1f ticks, %u/%u steps",
+             fixedWorst, floatWorst, unsigned(old.size()), unsigned(longTotal));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_EQUAL_UINT32(longTotal, fixed.size());
+    TEST_ASSERT_FLOAT_WITHIN(1.5, 0.0, fixedWorst);
+    TEST_ASSERT_TRUE(floatWorst > fixedWorst);
+}
+
+// A slow joint (25 steps/s²) at fast tick rates: the accel is a few Q32
+// LSBs at 100 kHz and under one at 1 MHz, but still plans within 1e-4 of
+// the request and lands every step
+void test_trapezoid_low_accel_lands_exactly()
+{
+    const uint32_t total = 20000;
+    const double v = 200, a = 25;
+    const double rates[] = {100000.0, 400000.0, 1000000.0};
+    for (double hz : rates)
+    {
+        TrapezoidProfile p;
+        TEST_ASSERT_TRUE(p.plan(total, float(v / hz), float(a / (hz * hz))));
+        double planned = ldexp(double(p.aQ), -int(Q32_SHIFT + ACCEL_SHIFT)) * hz * hz;
+        TEST_ASSERT_TRUE(fabs(planned - a) <= a * 1e-4);
+        TEST_ASSERT_TRUE(fabs(ldexp(double(p.vQ), -int(Q32_SHIFT)) * hz - v) <= v * 1e-3);
+
+        std::vector<uint32_t> steps = scanSteps(p, total, p.nTotal);
+        TEST_ASSERT_EQUAL_UINT32(total, steps.size());
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(p.nTotal, steps.back());
+        TEST_ASSERT_TRUE(p.sEndQ >= uint64_t(total) << Q32_SHIFT);
+        checkSearch(p, steps);
+        TEST_ASSERT_FLOAT_WITHIN(1.5, 0.0, worstIdealOffset(p, steps, hz));
+    }
+}
+
+// The jerk-limited profile over a long move: every step, in order, found
+// again by the search, ending on the target
+void test_scurve_long_move_lands_exactly()
+{
+    const uint32_t total = 1200000;
+    MoveProfile p;
+    TEST_ASSERT_TRUE(p.plan(total, float(2500 / HZ), float(5000 / (HZ * HZ)), float(100000 / (HZ * HZ * HZ))));
+    TEST_ASSERT_TRUE(p.sCurve);
+    std::vector<uint32_t> steps = scanSteps(p, total, p.totalTicks());
+    TEST_ASSERT_EQUAL_UINT32(total, steps.size());
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(p.totalTicks(), steps.back());
+    TEST_ASSERT_TRUE(p.positionAt(p.totalTicks()) >= uint64_t(total) << Q32_SHIFT);
+    checkSearch(p, steps);
+
+    // the planned peaks stay inside the limits asked for
+    TEST_ASSERT_TRUE(p.peakVelocity() <= float(2500 / HZ) * 1.0001f);
+    TEST_ASSERT_TRUE(p.peakAccel() <= float(5000 / (HZ * HZ)) * 1.0001f);
+}
+
+// The S-curve's closed form against an exact tick-by-tick accumulation:
+// jerk integrated into accel, accel into speed, speed into distance, all in
+// 128-bit integers of the planned jerk. Each phase is floored once, so the
+// two may differ by two Q32 LSBs and never drift.
+static void checkSCurveAgainstSum(uint32_t total, double v, double a, double j, double hz)
+{
+    SCurveProfile p;
+    TEST_ASSERT_TRUE(p.plan(total, float(v / hz), float(a / (hz * hz)), float(j / (hz * hz * hz))));
+    TEST_ASSERT_EQUAL_UINT32(2 * p.nAccel + p.nCruise, p.nTotal);
+
+    // speed of each accel tick in jerk units; braking replays it backwards
+    std::vector<uint64_t> ramp(p.nAccel + 1, 0);
+    uint64_t accel = 0;
+    for (uint32_t n = 1; n <= p.nAccel; ++n)
+    {
+        if (n <= p.nJerk)
+            ++accel;
+        else if (n > p.nJerk + p.nHold)
+            --accel;
+        ramp[n] = ramp[n - 1] + accel;
+    }
+    TEST_ASSERT_EQUAL_UINT64(0, accel);
+
+    unsigned __int128 sum = 0;
+    for (uint32_t n = 1; n <= p.nTotal; ++n)
+    {
+        if (n <= p.nAccel)
+            sum += ramp[n];
+        else if (n <= p.nAccel + p.nCruise)
+            sum += ramp[p.nAccel];
+        else
+            sum += ramp[p.nTotal - n + 1];
+        TEST_ASSERT_TRUE(sum < (unsigned __int128)1 << 66); // times a 62-bit jerk
+        uint64_t ref = uint64_t((sum * p.jerkQ) >> p.jerkShift);
+        uint64_t s = p.positionAt(n);
+        if (s + 2 < ref || s > ref + 2)
+            TEST_ASSERT_EQUAL_UINT64_MESSAGE(ref, s, "closed form left the running sum");
+    }
+    TEST_ASSERT_EQUAL_UINT64(p.sEndQ, p.positionAt(p.nTotal));
+    TEST_ASSERT_TRUE(p.sEndQ >= uint64_t(total) << Q32_SHIFT);
+
+    // the jerk is kept to 62 bits however small: the peaks sit on the
+    // limit that bound them rather than a quantization step below it
+    TEST_ASSERT_TRUE(p.jerkQ >> 61 == 1);
+    TEST_ASSERT_TRUE(p.vPeak <= v / hz * 1.000001);
+    TEST_ASSERT_TRUE(p.aPeak <= a / (hz * hz) * 1.000001);
+}
+
+void test_scurve_matches_integer_sum()
+{
+    checkSCurveAgainstSum(1200000, 2500, 5000, 100000, HZ);
+    checkSCurveAgainstSum(20000, 5000, 20000, 200000, 40000.0);
+    // a slow joint at 1 MHz: a jerk under 2^-50 steps/tick³
+    checkSCurveAgainstSum(2000, 20, 25, 100, 1000000.0);
+    checkSCurveAgainstSum(3, 3000, 6000, 60000, HZ);
+}
+
+// A duration-fitted move stretches every limit by the same factor until the
+// plan is exactly as long as asked; fine jerk resolution lets that settle
+// on the tick instead of hunting around it
+void test_scurve_stretch_lands_on_duration()
+{
+    const uint32_t want = 8000000; // 200 s at 40 kHz
+    const double hz = 40000.0, total = 20000;
+    double k = 1.0;
+    SCurveProfile p;
+    for (int i = 0; i < 6; ++i)
+    {
+        TEST_ASSERT_TRUE(p.plan(uint32_t(total), float(5000 / hz / k), float(20000 / (hz * hz) / (k * k)),
+                                float(200000 / (hz * hz * hz) / (k * k * k))));
+        k *= double(want) / p.nTotal;
+    }
+    TEST_ASSERT_INT_WITHIN(2, want, p.nTotal);
+}
+
+// Jog slews retargeted mid-ramp: each plan starts from the exact Q60 state
+// the previous one had reached, positions never go back, the accel moves
+// by at most the jerk limit per tick, and once settled every tick covers
+// exactly the held speed
+void test_scurve_ramp_retargets_continuously()
+{
+    const double aMax = 20000 / (HZ * HZ), jMax = 200000 / (HZ * HZ * HZ);
+    const int64_t jerkX = int64_t(ceil(ldexp(jMax, Q32_SHIFT + JERK_SHIFT)));
+    const double targets[] = {8000 / HZ, 2000 / HZ, 12000 / HZ, 0};
+    const uint32_t at[] = {300, 2500, 900, 0};
+
+    JogProfile jog;
+    jog.reset();
+    int64_t lastV = 0, lastA = 0;
+    uint32_t k = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        jog.retarget(k, targets[i], aMax, jMax);
+        TEST_ASSERT_TRUE(jog.sCurve);
+        int64_t v, a;
+        jog.curve.stateAt(0, v, a);
+        TEST_ASSERT_EQUAL_INT64(lastV, v);
+        TEST_ASSERT_EQUAL_INT64(lastA, a);
+
+        uint32_t end = at[i] ? at[i] : jog.settleTick() + 100;
+        uint64_t last = jog.positionAt(0);
+        for (uint32_t n = 1; n <= end; ++n)
+        {
+            uint64_t s = jog.positionAt(n);
+            TEST_ASSERT_TRUE_MESSAGE(s >= last, "position went backwards");
+            jog.curve.stateAt(n, v, a);
+            TEST_ASSERT_TRUE(v >= 0);
+            TEST_ASSERT_TRUE(llabs(a - lastA) <= jerkX);
+            if (n > jog.settleTick())
+                TEST_ASSERT_EQUAL_UINT64(jog.curve.vtQ, s - last);
+            last = s;
+            lastV = v;
+            lastA = a;
+        }
+        k = end;
+    }
+    TEST_ASSERT_EQUAL_UINT64(0, jog.curve.vtQ);
+}
+
+// Both shapes through MoveProfile, short to long: whole steps only, and
+// the last one no later than the profile's end
+void test_move_profile_step_counts()
+{
+    const uint32_t totals[] = {1, 2, 7, 100, 12345, 400000};
+    for (uint32_t total : totals)
+        for (int curve = 0; curve < 2; ++curve)
+        {
+            MoveProfile p;
+            float j = curve ? float(60000 / (HZ * HZ * HZ)) : 0.0f;
+            TEST_ASSERT_TRUE(p.plan(total, float(3000 / HZ), float(6000 / (HZ * HZ)), j));
+            std::vector<uint32_t> steps = scanSteps(p, total, p.totalTicks());
+            TEST_ASSERT_EQUAL_UINT32(total, steps.size());
+            TEST_ASSERT_LESS_OR_EQUAL_UINT32(p.totalTicks(), steps.back());
+            checkSearch(p, steps);
+        }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_trapezoid_exact_over_ten_minutes);
+    RUN_TEST(test_trapezoid_matches_float_generator);
+    RUN_TEST(test_trapezoid_low_accel_lands_exactly);
+    RUN_TEST(test_scurve_long_move_lands_exactly);
+    RUN_TEST(test_scurve_matches_integer_sum);
+    RUN_TEST(test_scurve_stretch_lands_on_duration);
+    RUN_TEST(test_scurve_ramp_retargets_continuously);
+    RUN_TEST(test_move_profile_step_counts);
+    return UNITY_END();
+}
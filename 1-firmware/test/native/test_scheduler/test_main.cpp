@@ -0,0 +1,188 @@
+// The event scheduler against the polled ISR: the same commands, issued
+// between the same ticks, step every joint to the same place on the same
+// ticks, or within the planner's chord of them.
+#include <unity.h>
+#include <algorithm>
+#include <stdlib.h>
+#include "StepSim.h"
+
+static constexpr uint32_t HZ = 100000;
+
+void setUp() {}
+void tearDown() {}
+
+// A move, a jog retargeted every 40 ticks and brought to rest, a
+// coordinated move and a late move on another joint, overlapping
+static void workload(StepSim &sim, uint32_t ticks)
+{
+    auto &sm = StepperManager::instance();
+    for (uint32_t t = 1; t <= ticks; ++t)
+    {
+        sim.tick();
+        if (t == 5)
+            sm.startMotion(0, 30000, 40000, 30000);
+        if (t == 10)
+            sm.startJog(1, +1, 8000, 20000);
+        if (t > 10 && t < 300000 && t % 40 == 7)
+            sm.setJogTarget(1, 8000 + float(t % 4000), 20000);
+        if (t == 300000)
+            sm.setJogTarget(1, 0, 20000);
+        if (t == 20)
+        {
+            long d[CONFIG_JOINT_COUNT] = {0, 0, 5000, -300, 77, 0};
+            float v[CONFIG_JOINT_COUNT], a[CONFIG_JOINT_COUNT];
+            for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            {
+                v[j] = 9000;
+                a[j] = 30000;
+            }
+            sm.startCoordinated(d, v, a);
+        }
+        if (t == 250000)
+            sm.startMotion(5, -4000, 60000, 90000, 400000);
+    }
+}
+
+static void run(StepSim &sim, StepSim::Scheduler mode, int64_t pos[CONFIG_JOINT_COUNT])
+{
+    sim.begin(HZ, mode);
+    workload(sim, 600000);
+    StepperManager::instance().stopJog(1); // a jog at rest stays alive
+    TEST_ASSERT_TRUE(sim.runUntilIdle(1000));
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        pos[j] = StepperManager::instance().getPosition(j);
+}
+
+// Largest distance (ticks) between matching edges of two runs, after
+// checking both made the same number of edges on every joint
+static int worstEdgeOffset(const StepSim &a, const StepSim &b)
+{
+    int worst = 0;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        TEST_ASSERT_EQUAL_UINT32(a.edges[j].size(), b.edges[j].size());
+        for (size_t k = 0; k < a.edges[j].size(); ++k)
+            worst = std::max(worst, abs(int(a.edges[j][k]) - int(b.edges[j][k])));
+    }
+    return worst;
+}
+
+// Without the planner the polled ISR evaluates the same closed forms the
+// event scheduler searches, so every edge lands on the same tick
+void test_event_matches_polled_closed_form()
+{
+    static StepSim polled, event;
+    int64_t pPos[CONFIG_JOINT_COUNT], ePos[CONFIG_JOINT_COUNT];
+    polled.runPlanner = false;
+    run(polled, StepSim::Scheduler::Polled, pPos);
+    run(event, StepSim::Scheduler::Event, ePos);
+
+    TEST_ASSERT_EQUAL_INT64_ARRAY(pPos, ePos, CONFIG_JOINT_COUNT);
+    TEST_ASSERT_EQUAL_INT(0, worstEdgeOffset(polled, event));
+    TEST_ASSERT_EQUAL_INT64(30000, pPos[0]);
+    TEST_ASSERT_EQUAL_INT64(5000, pPos[2]);
+    TEST_ASSERT_EQUAL_INT64(-4000, pPos[5]);
+}
+
+// Along the planner's chords the polled ISR follows 1 ms chords of the
+// same profiles: the same edges and end positions, each within two ticks
+void test_event_matches_polled_planner()
+{
+    static StepSim polled, event;
+    int64_t pPos[CONFIG_JOINT_COUNT], ePos[CONFIG_JOINT_COUNT];
+    StepperManager::instance().setChordStepping(true);
+    run(polled, StepSim::Scheduler::Polled, pPos);
+    StepperManager::instance().setChordStepping(false);
+    run(event, StepSim::Scheduler::Event, ePos);
+
+    TEST_ASSERT_EQUAL_INT64_ARRAY(pPos, ePos, CONFIG_JOINT_COUNT);
+    TEST_ASSERT_LESS_OR_EQUAL_INT(2, worstEdgeOffset(polled, event));
+}
+
+// Commands issued back to back, with no tick in between, neither block on
+// the commit still in flight nor drop it, in either scheduler
+void test_back_to_back_commits()
+{
+    const StepSim::Scheduler modes[] = {StepSim::Scheduler::Polled, StepSim::Scheduler::Event};
+    for (auto mode : modes)
+    {
+        static StepSim sim;
+        auto &sm = StepperManager::instance();
+        sim.begin(HZ, mode);
+        TEST_ASSERT_TRUE(sm.startMotion(0, 1000, 20000, 50000));
+        TEST_ASSERT_TRUE(sm.startMotion(1, -700, 20000, 50000));
+        TEST_ASSERT_TRUE(sm.queueMotion(2, 300, 20000, 50000, 0, 1));
+        TEST_ASSERT_TRUE(sm.startMotion(3, 50, 20000, 50000));
+        TEST_ASSERT_TRUE(sim.runUntilIdle(100000));
+        TEST_ASSERT_EQUAL_INT64(1000, sm.getPosition(0));
+        TEST_ASSERT_EQUAL_INT64(-700, sm.getPosition(1));
+        TEST_ASSERT_EQUAL_INT64(300, sm.getPosition(2));
+        TEST_ASSERT_EQUAL_INT64(50, sm.getPosition(3));
+    }
+}
+
+// stopJog ends a jog that was landing on a position for good, one still
+// in flight to the ISR included: it stays where it stopped and reports no
+// arrival
+void test_stop_jog_ends_landing()
+{
+    const StepSim::Scheduler modes[] = {StepSim::Scheduler::Polled, StepSim::Scheduler::Event};
+    for (auto mode : modes)
+    {
+        static StepSim sim;
+        auto &sm = StepperManager::instance();
+        sim.begin(HZ, mode);
+        sm.jogTo(0, 40000, 8000, 20000, 0, 7);
+        sim.run(50000);
+        sm.stopJog(0);
+        int64_t at = sm.getPosition(0);
+        TEST_ASSERT_TRUE(at > 0 && at < 40000);
+        TEST_ASSERT_TRUE(sim.runUntilIdle(10));
+        sim.run(600000);
+        TEST_ASSERT_EQUAL_INT64(at, sm.getPosition(0));
+        size_t j;
+        uint32_t id;
+        TEST_ASSERT_FALSE(sm.takeFinishedMove(j, id));
+
+        sm.jogTo(0, 0, 8000, 20000, 0, 8);
+        sm.stopJog(0); // no tick in between
+        sim.run(600000);
+        TEST_ASSERT_EQUAL_INT64(at, sm.getPosition(0));
+        TEST_ASSERT_FALSE(sm.takeFinishedMove(j, id));
+    }
+}
+
+// A guarded jog streamed against its soft limit, as slices are, brakes in
+// the planner IRQ onto the limit and stays there in either scheduler
+void test_guarded_jog_stops_at_limit()
+{
+    const StepSim::Scheduler modes[] = {StepSim::Scheduler::Polled, StepSim::Scheduler::Event};
+    for (auto mode : modes)
+    {
+        static StepSim sim;
+        auto &sm = StepperManager::instance();
+        sim.begin(HZ, mode);
+        sm.setSoftLimits(0, -5000, 20000, 1000);
+        int64_t peak = 0;
+        for (uint32_t t = 1; t <= 400000; ++t)
+        {
+            if (t % 400 == 10)
+                sm.setJogTarget(0, 9000, 90000, 2e6f);
+            sim.tick();
+            peak = std::max(peak, sm.getPosition(0));
+        }
+        TEST_ASSERT_TRUE(peak <= 20000);
+        TEST_ASSERT_TRUE(sm.getPosition(0) > 19900);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_event_matches_polled_closed_form);
+    RUN_TEST(test_event_matches_polled_planner);
+    RUN_TEST(test_back_to_back_commits);
+    RUN_TEST(test_stop_jog_ends_landing);
+    RUN_TEST(test_guarded_jog_stops_at_limit);
+    return UNITY_END();
+}
@@ -0,0 +1,78 @@
+// The velocity-slice limiter: one time scale for every joint, whichever
+// joint's speed or accel is over its limit, so the stepped slice keeps the
+// speed ratios (its direction in joint space) while slewing and after.
+#include <unity.h>
+#include <math.h>
+#include "StepSim.h"
+
+static constexpr uint32_t HZ = 100000;
+
+void setUp() {}
+void tearDown() {}
+
+// Joint 2's accel is four times its limit: k = 1/2 for all, every speed
+// halves and every accel quarters, joint 2 landing on its limit
+void test_scale_holds_every_limit()
+{
+    const float v[CONFIG_JOINT_COUNT] = {40, -20, 10, 0, 5, 0};
+    const float a[CONFIG_JOINT_COUNT] = {80, 40, 400, 0, 10, 0};
+    const float vMax[CONFIG_JOINT_COUNT] = {90, 90, 90, 90, 0, 90};
+    const float aMax[CONFIG_JOINT_COUNT] = {500, 500, 100, 500, 0, 500};
+    float k = sliceTimeScale(v, a, vMax, aMax, CONFIG_JOINT_COUNT);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.5f, k);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        if (aMax[j] > 0)
+            TEST_ASSERT_TRUE(a[j] * k * k <= aMax[j] * 1.000001f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, aMax[2], a[2] * k * k);
+
+    // a speed limit tighter than the accel's wins, and no limit is k = 1
+    const float vTight[CONFIG_JOINT_COUNT] = {10, 90, 90, 90, 0, 90};
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.25f, sliceTimeScale(v, a, vTight, aMax, CONFIG_JOINT_COUNT));
+    const float none[CONFIG_JOINT_COUNT] = {0, 0, 0, 0, 0, 0};
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, sliceTimeScale(v, a, none, none, CONFIG_JOINT_COUNT));
+}
+
+// From rest, joints 0 and 1 slew 2:1 with joint 1's accel over its limit.
+// Scaled as feedVelocitySlice does, both reach their speeds together and
+// step 2:1 all the way; clamping joint 1 alone would let joint 0 run ahead.
+void test_scaled_slice_keeps_speed_ratio()
+{
+    const StepSim::Scheduler modes[] = {StepSim::Scheduler::Polled, StepSim::Scheduler::Event};
+    for (auto mode : modes)
+    {
+        static StepSim sim;
+        auto &sm = StepperManager::instance();
+        sim.begin(HZ, mode);
+        float v[CONFIG_JOINT_COUNT] = {8000, -4000, 0, 0, 0, 0};
+        float a[CONFIG_JOINT_COUNT] = {40000, 20000, 0, 0, 0, 0};
+        const float vMax[CONFIG_JOINT_COUNT] = {20000, 20000, 0, 0, 0, 0};
+        const float aMax[CONFIG_JOINT_COUNT] = {60000, 5000, 0, 0, 0, 0};
+        float k = sliceTimeScale(v, a, vMax, aMax, CONFIG_JOINT_COUNT);
+        TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.5f, k);
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            v[j] *= k;
+            a[j] *= k * k;
+        }
+        sm.setJogTargetsAll(v, a);
+
+        // ramps take 0.4 s; check through them and into the cruise
+        for (int n = 1; n <= 8; ++n)
+        {
+            sim.run(HZ / 10);
+            int64_t p0 = sm.getPosition(0), p1 = sm.getPosition(1);
+            TEST_ASSERT_TRUE(p0 > 0 && p1 < 0);
+            TEST_ASSERT_INT_WITHIN(2, p0, -2 * p1);
+        }
+        sm.stopJog(0);
+        sm.stopJog(1);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_scale_holds_every_limit);
+    RUN_TEST(test_scaled_slice_keeps_speed_ratio);
+    return UNITY_END();
+}
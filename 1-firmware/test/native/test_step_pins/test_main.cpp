@@ -0,0 +1,156 @@
+// Port-level step writes, counted through the host StepPinIO fake: at most
+// one set and one clear store per step port per tick, and joints stepping
+// on the same tick rise and fall together.
+#include <unity.h>
+#include <map>
+#include "StepSim.h"
+
+static constexpr uint32_t HZ = 100000;
+
+void setUp() {}
+void tearDown() {}
+
+// Step pin bits per port register (set and clear registers both)
+static std::map<volatile uint32_t *, uint32_t> stepBits()
+{
+    std::map<volatile uint32_t *, uint32_t> bits;
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        uint8_t pin = JOINT_CONFIG[j].pulsePin;
+        bits[StepPinIO::setRegister(pin)] |= StepPinIO::bitMask(pin);
+        bits[StepPinIO::clearRegister(pin)] |= StepPinIO::bitMask(pin);
+    }
+    return bits;
+}
+
+// Tick of every falling step edge per joint, from the clear stores
+static void falls(const StepSim &sim, std::vector<uint32_t> out[CONFIG_JOINT_COUNT])
+{
+    for (const auto &w : sim.writes)
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            uint8_t pin = JOINT_CONFIG[j].pulsePin;
+            if (w.reg == StepPinIO::clearRegister(pin) && (w.mask & StepPinIO::bitMask(pin)))
+                out[j].push_back(w.tick);
+        }
+}
+
+// No tick stores to a step port register more than once, and a store that
+// touches step bits touches nothing else
+static void checkOneWritePerPortPerTick(const StepSim &sim)
+{
+    std::map<volatile uint32_t *, uint32_t> bits = stepBits();
+    std::map<volatile uint32_t *, uint32_t> lastTick;
+    size_t stepWrites = 0;
+    for (const auto &w : sim.writes)
+    {
+        auto b = bits.find(w.reg);
+        if (b == bits.end() || !(w.mask & b->second))
+            continue; // a dir pin on another port, or on this one
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, w.mask & ~b->second, "step store carries other pins");
+        auto last = lastTick.find(w.reg);
+        if (last != lastTick.end())
+            TEST_ASSERT_TRUE_MESSAGE(last->second != w.tick, "two stores to one step port in a tick");
+        lastTick[w.reg] = w.tick;
+        ++stepWrites;
+    }
+    TEST_ASSERT_TRUE(stepWrites > 0);
+}
+
+// Every rise is followed by its fall before the joint's next rise
+static void checkPulses(const StepSim &sim)
+{
+    std::vector<uint32_t> down[CONFIG_JOINT_COUNT];
+    falls(sim, down);
+    for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+    {
+        const std::vector<uint32_t> &up = sim.edges[j];
+        TEST_ASSERT_EQUAL_UINT32(up.size(), down[j].size());
+        for (size_t k = 0; k < up.size(); ++k)
+        {
+            TEST_ASSERT_TRUE(down[j][k] > up[k]);
+            if (k + 1 < up.size())
+                TEST_ASSERT_TRUE(down[j][k] <= up[k + 1]);
+        }
+    }
+}
+
+// Six joints on one coordinated line with equal deltas step on the same
+// ticks: their edges rise together and fall together, one store per port
+void test_coordinated_edges_aligned()
+{
+    const StepSim::Scheduler modes[] = {StepSim::Scheduler::Polled, StepSim::Scheduler::Event};
+    for (StepSim::Scheduler mode : modes)
+    {
+        static StepSim sim;
+        sim.logWrites = true;
+        sim.begin(HZ, mode);
+        long d[CONFIG_JOINT_COUNT];
+        float v[CONFIG_JOINT_COUNT], a[CONFIG_JOINT_COUNT];
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            d[j] = 4000;
+            v[j] = 20000;
+            a[j] = 50000;
+        }
+        TEST_ASSERT_TRUE(StepperManager::instance().startCoordinated(d, v, a));
+        TEST_ASSERT_TRUE(sim.runUntilIdle(HZ));
+        sim.run(10); // the last pulse falls after the joints are idle
+
+        std::vector<uint32_t> down[CONFIG_JOINT_COUNT];
+        falls(sim, down);
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            TEST_ASSERT_EQUAL_UINT32(4000, sim.edges[j].size());
+            TEST_ASSERT_EQUAL_UINT32_ARRAY(sim.edges[0].data(), sim.edges[j].data(), 4000);
+            TEST_ASSERT_EQUAL_UINT32(4000, down[j].size());
+            TEST_ASSERT_EQUAL_UINT32_ARRAY(down[0].data(), down[j].data(), 4000);
+        }
+        checkOneWritePerPortPerTick(sim);
+        checkPulses(sim);
+
+        // one set and one clear store per step port for each edge tick
+        size_t ports = stepBits().size();
+        size_t stepWrites = 0;
+        std::map<volatile uint32_t *, uint32_t> bits = stepBits();
+        for (const auto &w : sim.writes)
+            if (bits.count(w.reg) && (w.mask & bits[w.reg]))
+                ++stepWrites;
+        TEST_ASSERT_EQUAL_UINT32(4000 * ports, stepWrites);
+    }
+}
+
+// Independent moves at different speeds, both ways, with the edges of
+// different joints landing on shared ticks now and then
+void test_independent_moves_one_write_per_port()
+{
+    const StepSim::Scheduler modes[] = {StepSim::Scheduler::Polled, StepSim::Scheduler::Event};
+    for (StepSim::Scheduler mode : modes)
+    {
+        static StepSim sim;
+        sim.logWrites = true;
+        sim.begin(HZ, mode);
+        auto &sm = StepperManager::instance();
+        const long delta[] = {3000, -2500, 1800, -1200, 900, -3300};
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+            TEST_ASSERT_TRUE(sm.stageMotion(j, delta[j % 6], 6000 + 2500 * float(j), 40000));
+        TEST_ASSERT_TRUE(sm.commit());
+        TEST_ASSERT_TRUE(sim.runUntilIdle(2 * HZ));
+        sim.run(10);
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            TEST_ASSERT_EQUAL_INT64(delta[j % 6], sm.getPosition(j));
+            TEST_ASSERT_EQUAL_UINT32(labs(delta[j % 6]), sim.edges[j].size());
+        }
+        checkOneWritePerPortPerTick(sim);
+        checkPulses(sim);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_coordinated_edges_aligned);
+    RUN_TEST(test_independent_moves_one_write_per_port);
+    return UNITY_END();
+}
@@ -0,0 +1,284 @@
+#ifndef REFERENCE_BASELINE_STEPPER_H
+#define REFERENCE_BASELINE_STEPPER_H
+
+#include <Arduino.h>
+#include <cmath>
+#include <cstdlib>
+#include "Config.h"
+#include "IsrProfiler.h"
+
+// The step ISR as it stood before the fixed-point rework (b97735c): float
+// trapezoids in an array of MotionPlan structs, five parallel jog arrays,
+// and a motion-or-jog branch per joint. Kept only so the ISR benchmarks
+// can run it under the same workload and profiler as StepperManager; the
+// timer is the benchmark's, which calls isrHandler() once per tick.
+class BaselineStepper
+{
+public:
+    BaselineStepper()
+    {
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            _stepPins[j] = JOINT_CONFIG[j].pulsePin;
+            _dirPins[j] = JOINT_CONFIG[j].dirPin;
+            _isReversed[j] = JOINT_CONFIG[j].isReversed;
+            _positions[j] = 0;
+        }
+    }
+
+    void begin(uint32_t freqHz)
+    {
+        _dtSec = 1.0f / float(freqHz);
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            pinMode(_stepPins[j], OUTPUT);
+            pinMode(_dirPins[j], OUTPUT);
+            digitalWrite(_stepPins[j], LOW);
+            digitalWrite(_dirPins[j], LOW);
+            _motions[j].active = false;
+            _jogActive[j] = false;
+            _jogDir[j] = 0;
+            _jogTargetV[j] = 0;
+            _jogAccel[j] = 0;
+            _jogCurrentV[j] = 0;
+            _positions[j] = 0;
+        }
+        _profile.begin(uint32_t(CycleClock::hz() / freqHz), true);
+    }
+
+    bool startMotion(size_t joint, long deltaSteps, float vStepsPerSec, float aStepsPerSec2)
+    {
+        if (joint >= CONFIG_JOINT_COUNT || deltaSteps == 0)
+            return (deltaSteps == 0);
+
+        _jogActive[joint] = false;
+
+        auto &mp = _motions[joint];
+        mp.joint = joint;
+        mp.dir = (deltaSteps > 0 ? +1 : -1);
+        mp.startPos = _positions[joint];
+        mp.totalSteps = std::labs(deltaSteps);
+        mp.doneSteps = 0;
+        mp.vMax = fabsf(vStepsPerSec);
+        mp.aMax = fabsf(aStepsPerSec2);
+
+        float tA_full = mp.vMax / mp.aMax;
+        float dA_full = 0.5f * mp.aMax * tA_full * tA_full;
+        if (mp.totalSteps < 2 * dA_full)
+        {
+            float vPeak = sqrtf(mp.totalSteps * mp.aMax);
+            mp.vMax = vPeak;
+            mp.tAccel = vPeak / mp.aMax;
+            mp.tCruise = 0;
+        }
+        else
+        {
+            mp.tAccel = tA_full;
+            mp.tCruise = (mp.totalSteps - 2 * dA_full) / mp.vMax;
+        }
+        mp.tTotal = 2 * mp.tAccel + mp.tCruise;
+        mp.elapsed = 0;
+        mp.stepAcc = 0;
+        mp.currentV = 0;
+        mp.active = true;
+
+        bool raw = (mp.dir > 0);
+        bool fin = raw ^ _isReversed[joint];
+        digitalWriteFast(_dirPins[joint], fin ? HIGH : LOW);
+        return true;
+    }
+
+    bool startJog(size_t joint, int dir, float vStepsPerSec, float aStepsPerSec2)
+    {
+        if (joint >= CONFIG_JOINT_COUNT)
+            return false;
+
+        _motions[joint].active = false;
+
+        _jogActive[joint] = true;
+        _jogDir[joint] = (dir >= 0 ? +1 : -1);
+        _jogTargetV[joint] = fabsf(vStepsPerSec);
+        _jogAccel[joint] = fabsf(aStepsPerSec2);
+        _jogCurrentV[joint] = 0;
+        _jogRem[joint] = 0;
+
+        bool raw = (_jogDir[joint] > 0);
+        bool fin = raw ^ _isReversed[joint];
+        digitalWriteFast(_dirPins[joint], fin ? HIGH : LOW);
+        return true;
+    }
+
+    void setJogTarget(size_t joint, float vStepsPerSec, float aStepsPerSec2)
+    {
+        if (joint >= CONFIG_JOINT_COUNT)
+            return;
+        if (!_jogActive[joint])
+        {
+            startJog(joint, (vStepsPerSec >= 0 ? +1 : -1),
+                     fabsf(vStepsPerSec), fabsf(aStepsPerSec2));
+            return;
+        }
+        int newDir = (vStepsPerSec >= 0 ? +1 : -1);
+        if (newDir != _jogDir[joint])
+        {
+            _jogDir[joint] = newDir;
+            bool raw = (_jogDir[joint] > 0);
+            bool fin = raw ^ _isReversed[joint];
+            digitalWriteFast(_dirPins[joint], fin ? HIGH : LOW);
+        }
+        _jogTargetV[joint] = fabsf(vStepsPerSec);
+        _jogAccel[joint] = fabsf(aStepsPerSec2);
+    }
+
+    void emergencyStop()
+    {
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            _jogActive[j] = false;
+            _motions[j].active = false;
+        }
+    }
+
+    long getPosition(size_t j) const
+    {
+        noInterrupts();
+        long p = _positions[j];
+        interrupts();
+        return p;
+    }
+
+    long getTargetSteps(size_t j) const
+    {
+        const auto &mp = _motions[j];
+        return mp.active ? (mp.startPos + mp.dir * mp.totalSteps)
+                         : _positions[j];
+    }
+
+    // As StepperManager::getIsrStats, masked by the caller on the board
+    void getIsrStats(IsrStats &out, bool reset)
+    {
+        out = _profile.stats();
+        if (reset)
+            _profile.reset();
+    }
+
+    // The b97735c handler, unchanged but for the profiler at entry and exit
+    void isrHandler()
+    {
+        uint32_t c0 = CycleClock::now();
+
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            if (_pulseHigh[j])
+            {
+                digitalWriteFast(_stepPins[j], LOW);
+                _pulseHigh[j] = false;
+            }
+        }
+
+        for (size_t j = 0; j < CONFIG_JOINT_COUNT; ++j)
+        {
+            float v = 0;
+            int dir = 0;
+            bool runMotion = false;
+
+            auto &mp = _motions[j];
+            if (mp.active)
+            {
+                mp.elapsed += _dtSec;
+                if (mp.elapsed < mp.tAccel)
+                    v = mp.aMax * mp.elapsed;
+                else if (mp.elapsed < mp.tAccel + mp.tCruise)
+                    v = mp.vMax;
+                else if (mp.elapsed < mp.tTotal)
+                {
+                    float td = mp.elapsed - (mp.tAccel + mp.tCruise);
+                    v = mp.vMax - mp.aMax * td;
+                    if (v < 0)
+                        v = 0;
+                }
+                else
+                {
+                    mp.active = false;
+                    continue;
+                }
+                if (v > mp.vMax)
+                    v = mp.vMax;
+                dir = mp.dir;
+                mp.currentV = v;
+                runMotion = true;
+            }
+            else if (_jogActive[j])
+            {
+                float dv = _jogAccel[j] * _dtSec;
+                float v0 = _jogCurrentV[j], vt = _jogTargetV[j];
+                float v1 = (fabsf(vt - v0) <= dv) ? vt : (v0 + ((vt > v0) ? dv : -dv));
+                _jogCurrentV[j] = v1;
+                v = v1;
+                dir = _jogDir[j];
+                runMotion = (v1 > 0.0f);
+            }
+
+            if (!runMotion)
+                continue;
+
+            float &acc = mp.stepAcc;
+            acc += v * _dtSec;
+            int steps = int(floorf(acc));
+            acc -= float(steps);
+
+            if (mp.active && (mp.doneSteps + steps >= mp.totalSteps))
+            {
+                steps = mp.totalSteps - mp.doneSteps;
+                mp.active = false;
+            }
+            mp.doneSteps += steps;
+
+            while (steps-- > 0)
+            {
+                digitalWriteFast(_stepPins[j], HIGH);
+                _pulseHigh[j] = true;
+                _positions[j] += (dir > 0 ? +1 : -1);
+            }
+        }
+
+        _profile.record(c0, CycleClock::now());
+    }
+
+private:
+    bool _pulseHigh[CONFIG_JOINT_COUNT] = {false};
+    uint8_t _stepPins[CONFIG_JOINT_COUNT];
+    uint8_t _dirPins[CONFIG_JOINT_COUNT];
+    bool _isReversed[CONFIG_JOINT_COUNT];
+    volatile long _positions[CONFIG_JOINT_COUNT];
+
+    struct MotionPlan
+    {
+        bool active = false;
+        size_t joint = 0;
+        int dir = +1;
+        long totalSteps = 0;
+        long doneSteps = 0;
+        long startPos = 0;
+        float vMax = 0;
+        float aMax = 0;
+        float tAccel = 0;
+        float tCruise = 0;
+        float tTotal = 0;
+        float elapsed = 0;
+        float stepAcc = 0;
+        float currentV = 0;
+    } _motions[CONFIG_JOINT_COUNT];
+
+    bool _jogActive[CONFIG_JOINT_COUNT] = {false};
+    int _jogDir[CONFIG_JOINT_COUNT] = {0};
+    float _jogTargetV[CONFIG_JOINT_COUNT] = {0};
+    float _jogAccel[CONFIG_JOINT_COUNT] = {0};
+    float _jogCurrentV[CONFIG_JOINT_COUNT] = {0};
+    float _jogRem[CONFIG_JOINT_COUNT] = {0};
+
+    float _dtSec = 0;
+    IsrProfiler _profile;
+};
+
+#endif // REFERENCE_BASELINE_STEPPER_H